@@ -0,0 +1,135 @@
+#!/usr/bin/env node
+// Compile a list of wasm modules into the AOT cache ahead of time, so that
+// the first EnableAOT call of a production process does not pay for the
+// compilation.
+//
+// Usage: wasmedge-precompile [-j jobs] [--cache-dir dir] manifest.json
+//
+// The manifest is a JSON array. Each entry is either the path of a wasm file
+// or an object { "path": "...", "options": { ... } } where the options are the
+// ones given to the VM constructor (e.g. AOTOptimizationLevel), because they
+// are part of the cache key. Relative paths are resolved against the manifest.
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const {Worker, isMainThread, parentPort} = require('worker_threads');
+
+function usage() {
+  console.error(
+      'Usage: wasmedge-precompile [-j jobs] [--cache-dir dir] manifest.json');
+  process.exit(2);
+}
+
+function parseArgs(argv) {
+  let args = {jobs : os.cpus().length, cacheDir : undefined, manifest : ''};
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i] === '-j' || argv[i] === '--jobs') {
+      args.jobs = parseInt(argv[++i]);
+    } else if (argv[i] === '--cache-dir') {
+      args.cacheDir = argv[++i];
+    } else if (!args.manifest) {
+      args.manifest = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if (!args.manifest || !(args.jobs > 0)) {
+    usage();
+  }
+  return args;
+}
+
+function readManifest(manifest) {
+  let dir = path.dirname(path.resolve(manifest));
+  let entries = JSON.parse(fs.readFileSync(manifest, 'utf8'));
+  if (!Array.isArray(entries)) {
+    throw new Error(manifest + ': the manifest must be an array');
+  }
+  // The same module with the same options only needs to be compiled once
+  let seen = new Map();
+  for (let entry of entries) {
+    if (typeof entry === 'string') {
+      entry = {path : entry};
+    }
+    let job = {
+      path : path.resolve(dir, entry.path),
+      options : Object.assign({}, entry.options || {}, {EnableAOT : true}),
+    };
+    seen.set(JSON.stringify(job), job);
+  }
+  return Array.from(seen.values());
+}
+
+function runWorker() {
+  const ssvm = require('..');
+  parentPort.on('message', (job) => {
+    let start = process.hrtime.bigint();
+    try {
+      let vm = new ssvm.VM(job.path, job.options);
+      let res = vm.Precompile();
+      parentPort.postMessage({
+        job : job,
+        path : res.Path,
+        cached : res.Cached,
+        ms : Number(process.hrtime.bigint() - start) / 1e6,
+      });
+    } catch (e) {
+      parentPort.postMessage({job : job, error : e.message});
+    }
+  });
+}
+
+function main() {
+  let args = parseArgs(process.argv.slice(2));
+  if (args.cacheDir) {
+    // Inherited by the workers and read by the addon
+    fs.mkdirSync(args.cacheDir, {recursive : true});
+    process.env.WASMEDGE_CACHE_DIR = path.resolve(args.cacheDir);
+  }
+  let jobs = readManifest(args.manifest);
+  let failed = 0;
+  let pending = jobs.length;
+  let next = 0;
+  if (pending === 0) {
+    return;
+  }
+
+  let workers = [];
+  let dispatch = (worker) => {
+    if (next < jobs.length) {
+      worker.postMessage(jobs[next++]);
+    } else {
+      worker.terminate();
+    }
+  };
+  for (let i = 0; i < Math.min(args.jobs, jobs.length); i++) {
+    let worker = new Worker(__filename);
+    worker.on('message', (msg) => {
+      if (msg.error) {
+        failed++;
+        console.error(`failed   ${msg.job.path}: ${msg.error}`);
+      } else if (msg.cached) {
+        console.log(`cached   ${msg.job.path} -> ${msg.path}`);
+      } else {
+        console.log(`compiled ${msg.job.path} -> ${msg.path} (${
+            msg.ms.toFixed(0)} ms)`);
+      }
+      if (--pending === 0) {
+        process.exitCode = failed ? 1 : 0;
+      }
+      dispatch(worker);
+    });
+    worker.on('error', (e) => {
+      console.error(e);
+      process.exitCode = 1;
+    });
+    workers.push(worker);
+    dispatch(worker);
+  }
+}
+
+if (isMainThread) {
+  main();
+} else {
+  runWorker();
+}
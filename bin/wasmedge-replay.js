@@ -0,0 +1,228 @@
+#!/usr/bin/env node
+// Replay the calls recorded with the Record option against a build of the
+// module, and compare their latency with the recorded one, so that captured
+// production traffic becomes a regression benchmark.
+//
+// Usage: wasmedge-replay [options] log module.wasm
+//   --options '{...}'   options of the VM, e.g. '{"EnableAOT":true}'
+//   --repeat 1          replays of the whole log
+//   --warmup 0          calls replayed first and not measured
+//   --max-slowdown pct  exit with 1 when a function gets slower by more
+//   --out report.json   write the report there instead of stdout
+//
+// The exit code is also 1 when a call which succeeded when recorded fails
+// now, or the other way round.
+const fs = require('fs');
+
+const kMagic = 'WERC';
+const kVersion = 1;
+const kMethods = [
+  'RunInt',
+  'RunUInt',
+  'RunInt64',
+  'RunUInt64',
+  'RunString',
+  'RunUint8Array',
+];
+
+function usage() {
+  console.error('Usage: wasmedge-replay [--options json] [--repeat n] ' +
+                '[--warmup n] [--max-slowdown pct] [--out file] log module');
+  process.exit(2);
+}
+
+function parseArgs(argv) {
+  let args = {
+    options : {},
+    repeat : 1,
+    warmup : 0,
+    maxSlowdown : Infinity,
+    out : '',
+    files : [],
+  };
+  for (let i = 0; i < argv.length; i++) {
+    switch (argv[i]) {
+    case '--options':
+      args.options = JSON.parse(argv[++i]);
+      break;
+    case '--repeat':
+      args.repeat = parseInt(argv[++i]);
+      break;
+    case '--warmup':
+      args.warmup = parseInt(argv[++i]);
+      break;
+    case '--max-slowdown':
+      args.maxSlowdown = parseFloat(argv[++i]);
+      break;
+    case '--out':
+      args.out = argv[++i];
+      break;
+    default:
+      args.files.push(argv[i]);
+    }
+  }
+  if (args.files.length !== 2 || !(args.repeat > 0)) {
+    usage();
+  }
+  return args;
+}
+
+// Decode a log written by the Record option, see src/recorder.h
+function readLog(file) {
+  let buf = fs.readFileSync(file);
+  if (buf.length < 8 || buf.toString('latin1', 0, 4) !== kMagic) {
+    throw new Error(file + ': not a WasmEdge record log');
+  }
+  if (buf.readUInt32LE(4) !== kVersion) {
+    throw new Error(file + ': unsupported log version ' + buf.readUInt32LE(4));
+  }
+  let records = [];
+  let pos = 8;
+  // A log cut while being written ends with a partial record
+  while (pos + 4 <= buf.length) {
+    let end = pos + 4 + buf.readUInt32LE(pos);
+    if (end > buf.length) {
+      break;
+    }
+    let method = kMethods[buf.readUInt8(pos + 4)];
+    let record = {
+      method : method,
+      ok : buf.readUInt8(pos + 5) === 1,
+      startMs : Number(buf.readBigUInt64LE(pos + 6)) / 1e3,
+      us : Number(buf.readBigUInt64LE(pos + 14)) / 1e3,
+      name : '',
+      args : [],
+    };
+    pos += 22;
+    let nameSize = buf.readUInt16LE(pos);
+    record.name = buf.toString('utf8', pos + 2, pos + 2 + nameSize);
+    pos += 2 + nameSize;
+    let argCount = buf.readUInt16LE(pos);
+    pos += 2;
+    for (let i = 0; i < argCount; i++) {
+      let type = buf.readUInt8(pos++);
+      if (type === 0) {
+        record.args.push(buf.readDoubleLE(pos));
+        pos += 8;
+      } else if (type === 1) {
+        let v = buf.readBigInt64LE(pos);
+        record.args.push(method === 'RunUInt64' ? BigInt.asUintN(64, v) : v);
+        pos += 8;
+      } else {
+        let size = buf.readUInt32LE(pos);
+        let bytes = buf.subarray(pos + 4, pos + 4 + size);
+        record.args.push(type === 2 ? bytes.toString('utf8')
+                                    : Uint8Array.from(bytes));
+        pos += 4 + size;
+      }
+    }
+    if (method !== undefined) {
+      records.push(record);
+    }
+    pos = end;
+  }
+  return records;
+}
+
+function percentiles(list) {
+  let us = Float64Array.from(list).sort();
+  let at = (p) => us[Math.min(us.length - 1, Math.floor(p * us.length))];
+  return {p50Us : at(0.5), p99Us : at(0.99)};
+}
+
+function delta(now, before) {
+  return before > 0 ? (now / before - 1) * 100 : 0;
+}
+
+function replay(records, vm, args) {
+  let call = (r) => {
+    try {
+      vm[r.method](r.name, ...r.args);
+      return true;
+    } catch (e) {
+      return false;
+    }
+  };
+  for (let i = 0; i < Math.min(args.warmup, records.length); i++) {
+    call(records[i]);
+  }
+
+  let funcs = new Map();
+  for (let n = 0; n < args.repeat; n++) {
+    for (let r of records) {
+      let start = process.hrtime.bigint();
+      let ok = call(r);
+      let us = Number(process.hrtime.bigint() - start) / 1e3;
+      let f = funcs.get(r.name);
+      if (!f) {
+        f = {recorded : [], replayed : [], mismatches : 0};
+        funcs.set(r.name, f);
+      }
+      if (n === 0) {
+        f.recorded.push(r.us);
+      }
+      f.replayed.push(us);
+      f.mismatches += ok === r.ok ? 0 : 1;
+    }
+  }
+
+  let report = {};
+  for (let [name, f] of funcs) {
+    let recorded = percentiles(f.recorded);
+    let replayed = percentiles(f.replayed);
+    report[name] = {
+      calls : f.recorded.length,
+      recorded : recorded,
+      replayed : replayed,
+      deltaP50 : delta(replayed.p50Us, recorded.p50Us),
+      deltaP99 : delta(replayed.p99Us, recorded.p99Us),
+      mismatches : f.mismatches,
+    };
+  }
+  return report;
+}
+
+function main() {
+  let args = parseArgs(process.argv.slice(2));
+  const ssvm = require('..');
+  let records = readLog(args.files[0]);
+  // Replaying must not record into the log again
+  let options = Object.assign({}, args.options);
+  delete options.Record;
+  let vm = new ssvm.VM(args.files[1], options);
+  let functions = replay(records, vm, args);
+
+  let failed = [];
+  for (let [name, f] of Object.entries(functions)) {
+    if (f.mismatches > 0) {
+      failed.push(`${name}: ${f.mismatches} calls changed their outcome`);
+    }
+    if (f.deltaP50 > args.maxSlowdown) {
+      failed.push(`${name}: p50 is ${f.deltaP50.toFixed(1)}% slower`);
+    }
+  }
+  let text = JSON.stringify({
+    log : args.files[0],
+    module : args.files[1],
+    options : options,
+    records : records.length,
+    repeat : args.repeat,
+    functions : functions,
+    failed : failed,
+  }, null, 2);
+  if (args.out) {
+    fs.writeFileSync(args.out, text + '\n');
+  } else {
+    console.log(text);
+  }
+  if (failed.length) {
+    console.error('Regressions:\n  ' + failed.join('\n  '));
+    process.exitCode = 1;
+  }
+}
+
+if (require.main === module) {
+  main();
+} else {
+  module.exports = {readLog : readLog, replay : replay};
+}
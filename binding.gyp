@@ -13,7 +13,23 @@
       "sources": [
         "src/addon.cc",
         "src/bytecode.cc",
+        "src/compiler.cc",
+        "src/compilelock.cc",
+        "src/dependency.cc",
+        "src/hostfunction.cc",
+        "src/instance.cc",
+        "src/memfs.cc",
+        "src/memocache.cc",
+        "src/msgpack.cc",
         "src/options.cc",
+        "src/parallel.cc",
+        "src/prefault.cc",
+        "src/recorder.cc",
+        "src/scheduler.cc",
+        "src/session.cc",
+        "src/sharedmodule.cc",
+        "src/swapmodule.cc",
+        "src/universal.cc",
         "src/wasmedgeaddon.cc",
         "src/utils.cc",
       ],
@@ -22,7 +38,7 @@
         "src",
         "/usr/local/include",
       ],
-      'defines': [ 'NAPI_DISABLE_CPP_EXCEPTIONS' ],
+      'defines': [ 'NAPI_DISABLE_CPP_EXCEPTIONS', 'NAPI_VERSION=6' ],
     },
     {
       "target_name": "action_after_build",
@@ -4,5 +4,94 @@ var binding_path =
     binary.find(path.resolve(path.join(__dirname, './package.json')));
 
 const os = require('os');
-process.dlopen(module, binding_path,
-               os.constants.dlopen.RTLD_LAZY | os.constants.dlopen.RTLD_GLOBAL);
+// The addon is context-aware, load it privately so that every worker thread
+// gets its own instance.
+process.dlopen(module, binding_path, os.constants.dlopen.RTLD_LAZY);
+
+const {Transform} = require('stream');
+
+// Wrap StreamBegin()/StreamWrite()/StreamEnd() into a Transform stream.
+// Every input chunk is passed to `writeFunc(ptr, len)` of a single live
+// instance, and the bytes it returns are pushed as soon as they are produced.
+// The stream buffers at most `highWaterMark` bytes on each side and applies
+// backpressure on the writer, so the data is processed in constant memory.
+module.exports.VM.prototype.Stream = function(writeFunc, endFunc, options) {
+  const vm = this;
+  const opts = Object.assign({highWaterMark : 1 << 20}, options);
+  const maxChunkSize = opts.maxChunkSize || opts.highWaterMark;
+  let started = false;
+
+  return new Transform({
+    highWaterMark : opts.highWaterMark,
+    transform(chunk, encoding, callback) {
+      try {
+        if (!started) {
+          vm.StreamBegin();
+          started = true;
+        }
+        if (typeof chunk === 'string') {
+          chunk = Buffer.from(chunk, encoding);
+        }
+        // Bound the size of each guest allocation
+        for (let off = 0; off < chunk.length; off += maxChunkSize) {
+          const out = vm.StreamWrite(
+              writeFunc, chunk.subarray(off, off + maxChunkSize));
+          if (out.length > 0) {
+            this.push(out);
+          }
+        }
+        callback();
+      } catch (err) {
+        started = false;
+        callback(err);
+      }
+    },
+    flush(callback) {
+      try {
+        if (!started) {
+          vm.StreamBegin();
+        }
+        started = false;
+        const out = vm.StreamEnd(endFunc);
+        if (out && out.length > 0) {
+          this.push(out);
+        }
+        callback();
+      } catch (err) {
+        callback(err);
+      }
+    },
+    destroy(err, callback) {
+      if (started) {
+        started = false;
+        vm.StreamEnd();
+      }
+      callback(err);
+    },
+  });
+};
+
+// Handle on the live instance of one session key, see VM.SessionRun(). The
+// instance is created by the first call and kept until End(), an eviction by
+// a newer session over MaxSessions, SessionIdleTimeout or a failed call.
+class Session {
+  constructor(vm, key) {
+    this.vm = vm;
+    this.key = String(key);
+  }
+
+  RunUint8Array(func, bytes) {
+    return this.vm.SessionRun(this.key, func, bytes);
+  }
+
+  RunString(func, string) {
+    const out = this.vm.SessionRun(this.key, func, string);
+    return Buffer.from(out.buffer, out.byteOffset, out.length).toString();
+  }
+
+  End() { return this.vm.SessionEnd(this.key); }
+}
+
+module.exports.VM.prototype.Session = function(key) {
+  return new Session(this, key);
+};
@@ -1,5 +1,7 @@
 #include "bytecode.h"
+#include "cache.h"
 
+#include <cstdio>
 #include <fstream>
 
 #include <boost/functional/hash.hpp>
@@ -8,6 +10,74 @@
 namespace WASMEDGE {
 namespace NAPI {
 
+namespace {
+/// Minimal reader of the wasm binary format, enough to walk the sections.
+class WasmReader {
+private:
+  const uint8_t *Cur;
+  const uint8_t *End;
+
+public:
+  WasmReader(const uint8_t *Begin, const uint8_t *End) : Cur(Begin), End(End) {}
+
+  bool eof() const noexcept { return Cur >= End; }
+  bool readByte(uint8_t &Byte) noexcept {
+    if (Cur >= End) {
+      return false;
+    }
+    Byte = *Cur++;
+    return true;
+  }
+  bool readU32(uint32_t &Value) noexcept {
+    Value = 0;
+    for (uint32_t Shift = 0; Shift < 35; Shift += 7) {
+      uint8_t Byte;
+      if (!readByte(Byte)) {
+        return false;
+      }
+      Value |= static_cast<uint32_t>(Byte & 0x7f) << Shift;
+      if ((Byte & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+  bool skip(uint32_t Size) noexcept {
+    if (static_cast<size_t>(End - Cur) < Size) {
+      return false;
+    }
+    Cur += Size;
+    return true;
+  }
+  bool readName(std::string &Name) noexcept {
+    uint32_t Size;
+    if (!readU32(Size) || static_cast<size_t>(End - Cur) < Size) {
+      return false;
+    }
+    Name.assign(reinterpret_cast<const char *>(Cur), Size);
+    Cur += Size;
+    return true;
+  }
+  const uint8_t *tell() const noexcept { return Cur; }
+  void seek(const uint8_t *Pos) noexcept { Cur = Pos; }
+  bool skipLimits() noexcept {
+    uint8_t Flags;
+    uint32_t Value;
+    if (!readByte(Flags) || !readU32(Value)) {
+      return false;
+    }
+    return (Flags & 0x01) == 0 || readU32(Value);
+  }
+};
+
+/// Magic number of a wasm module, followed by at least the version
+inline bool isWasmCode(const std::vector<uint8_t> &Code) {
+  return Code.size() >= 8 && Code[0] == 0x00 && Code[1] == 0x61 &&
+         Code[2] == 0x73 && Code[3] == 0x6d;
+}
+
+} // namespace
+
 void Bytecode::setPath(const std::string &IPath) noexcept {
   Path = IPath;
   Mode = InputMode::FilePath;
@@ -43,12 +113,17 @@ void Bytecode::setFileMode() noexcept {
     return;
   }
   size_t CodeHash = boost::hash_range(Data.begin(), Data.end());
-  Path = std::string("/tmp/wasmedge.tmp.") + std::to_string(CodeHash) +
-         std::string(".wasm");
-  std::ofstream File(Path.c_str());
-  std::ostream_iterator<uint8_t> OutIter(File);
-  std::copy(Data.begin(), Data.end(), OutIter);
+  Path = Cache::getDir() + std::string("/wasmedge.tmp.") +
+         std::to_string(CodeHash) + std::string(".wasm");
+  /// Other processes and threads may be reading the same file, replace it
+  /// atomically
+  std::string TmpPath = Cache::getTmpPath(Path);
+  std::ofstream File(TmpPath.c_str(), std::ios::binary);
+  File.write(reinterpret_cast<const char *>(Data.data()), Data.size());
   File.close();
+  if (!File || std::rename(TmpPath.c_str(), Path.c_str()) != 0) {
+    std::remove(TmpPath.c_str());
+  }
   Mode = InputMode::FilePath;
 }
 
@@ -104,5 +179,102 @@ bool Bytecode::isValidData() const noexcept {
   return false;
 }
 
+bool Bytecode::getImportModuleNames(const std::vector<uint8_t> &Code,
+                                    std::set<std::string> &Names) noexcept {
+  if (!isWasmCode(Code)) {
+    return false;
+  }
+
+  WasmReader Reader(Code.data() + 8, Code.data() + Code.size());
+  while (!Reader.eof()) {
+    uint8_t Id;
+    uint32_t Size;
+    if (!Reader.readByte(Id) || !Reader.readU32(Size)) {
+      return false;
+    }
+    if (Id != 0x02) {
+      /// Custom sections may appear anywhere, the import section comes
+      /// before all the other known sections.
+      if (Id > 0x02) {
+        return true;
+      }
+      if (!Reader.skip(Size)) {
+        return false;
+      }
+      continue;
+    }
+
+    uint32_t Count;
+    if (!Reader.readU32(Count)) {
+      return false;
+    }
+    for (uint32_t I = 0; I < Count; ++I) {
+      std::string Module, Field;
+      uint8_t Kind, Byte;
+      uint32_t Index;
+      if (!Reader.readName(Module) || !Reader.readName(Field) ||
+          !Reader.readByte(Kind)) {
+        return false;
+      }
+      bool Ok = false;
+      switch (Kind) {
+      case 0x00: // function
+        Ok = Reader.readU32(Index);
+        break;
+      case 0x01: // table
+        Ok = Reader.readByte(Byte) && Reader.skipLimits();
+        break;
+      case 0x02: // memory
+        Ok = Reader.skipLimits();
+        break;
+      case 0x03: // global
+        Ok = Reader.readByte(Byte) && Reader.readByte(Byte);
+        break;
+      default:
+        break;
+      }
+      if (!Ok) {
+        return false;
+      }
+      Names.insert(std::move(Module));
+    }
+    return true;
+  }
+  return true;
+}
+
+bool Bytecode::findCustomSection(const std::vector<uint8_t> &Code,
+                                 const std::string &Name, size_t &Begin,
+                                 size_t &Payload, size_t &End) noexcept {
+  if (!isWasmCode(Code)) {
+    return false;
+  }
+
+  const uint8_t *Start = Code.data();
+  WasmReader Reader(Start + 8, Start + Code.size());
+  while (!Reader.eof()) {
+    const uint8_t *Section = Reader.tell();
+    uint8_t Id;
+    uint32_t Size;
+    if (!Reader.readByte(Id) || !Reader.readU32(Size)) {
+      return false;
+    }
+    const uint8_t *Content = Reader.tell();
+    std::string SectionName;
+    if (Id == 0x00 && Reader.readName(SectionName) && SectionName == Name &&
+        Reader.tell() <= Content + Size) {
+      Begin = Section - Start;
+      Payload = Reader.tell() - Start;
+      End = Content + Size - Start;
+      return End <= Code.size();
+    }
+    Reader.seek(Content);
+    if (!Reader.skip(Size)) {
+      return false;
+    }
+  }
+  return false;
+}
+
 } // namespace NAPI
 } // namespace WASMEDGE
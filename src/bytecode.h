@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -34,6 +35,18 @@ public:
   bool isMachO() const noexcept;
   bool isCompiled() const noexcept;
   bool isValidData() const noexcept;
+  /// Both scans work on bytes which the caller already read from getData(),
+  /// so that a file is read once for all of them.
+  /// Collect the module names referenced by the import section of Code.
+  /// Return false when they cannot be known, e.g. for AOT compiled or
+  /// malformed input.
+  static bool getImportModuleNames(const std::vector<uint8_t> &Code,
+                                   std::set<std::string> &Names) noexcept;
+  /// Locate the custom section Name of the wasm module Code. [Begin, End)
+  /// covers the whole section and its content starts at Payload.
+  static bool findCustomSection(const std::vector<uint8_t> &Code,
+                                const std::string &Name, size_t &Begin,
+                                size_t &Payload, size_t &End) noexcept;
 };
 
 } // namespace NAPI
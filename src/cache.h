@@ -1,23 +1,68 @@
 #pragma once
 
+#include <cstdio>
+#include <cstdlib>
 #include <fstream> // std::ifstream, std::ofstream
 #include <iterator>
 #include <limits>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
 
 #include <boost/functional/hash.hpp>
 
 namespace WASMEDGE {
 namespace NAPI {
 
+/// Environment variable which overrides the directory of the AOT cache, so that
+/// the cache can be warmed at build time and shipped with the application.
+static inline std::string kCacheDirEnvString [[maybe_unused]] =
+    "WASMEDGE_CACHE_DIR";
+
 class Cache {
 private:
   std::string Path;
   size_t CodeHash;
 
 public:
+  static inline std::string getDir() {
+    const char *Dir = std::getenv(kCacheDirEnvString.c_str());
+    if (Dir == nullptr || Dir[0] == '\0') {
+      return "/tmp";
+    }
+    return Dir;
+  }
+
+  /// A file name next to Path which no other process or thread writes to.
+  /// Files are written there and published with rename(), so a partial file
+  /// is never seen at Path.
+  static inline std::string getTmpPath(const std::string &Path,
+                                       const std::string &Suffix = "") {
+    std::ostringstream TmpPath;
+    TmpPath << Path << '.' << getpid() << '.' << std::this_thread::get_id()
+            << Suffix;
+    return TmpPath.str();
+  }
+
   inline void init(const std::vector<uint8_t> &Data) {
-    Path = std::string("/tmp/wasmedge.tmp.") + std::to_string(hash(Data)) +
+    Path = getDir() + std::string("/wasmedge.tmp.") +
+           std::to_string(hash(Data)) + std::string(".so");
+  }
+
+  /// Compiled code also depends on the compiler configuration, which is
+  /// folded into the hash unless it is the default one.
+  inline void init(const std::vector<uint8_t> &Data,
+                   const std::string &ConfigKey) {
+    if (ConfigKey.empty()) {
+      init(Data);
+      return;
+    }
+    size_t Hash = hash(Data);
+    boost::hash_combine(Hash, ConfigKey);
+    CodeHash = Hash;
+    Path = getDir() + std::string("/wasmedge.tmp.") + std::to_string(Hash) +
            std::string(".so");
   }
 
@@ -35,12 +80,20 @@ public:
 
   inline const std::string &getPath() const noexcept { return Path; }
 
+  /// The file is named by the hash of Data, an existing one is not rewritten
+  /// while other VMs or processes may have it loaded.
   inline void dumpToFile(const std::vector<uint8_t> &Data) {
     init(Data);
-    std::ofstream File(Path.c_str());
-    std::ostream_iterator<uint8_t> OutIter(File);
-    std::copy(Data.begin(), Data.end(), OutIter);
+    if (isCached()) {
+      return;
+    }
+    std::string TmpPath = getTmpPath(Path);
+    std::ofstream File(TmpPath.c_str(), std::ios::binary);
+    File.write(reinterpret_cast<const char *>(Data.data()), Data.size());
     File.close();
+    if (!File || std::rename(TmpPath.c_str(), Path.c_str()) != 0) {
+      std::remove(TmpPath.c_str());
+    }
   }
 };
 
@@ -0,0 +1,78 @@
+#include "compilelock.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+namespace {
+/// One mutex per cache entry, shared by all the VMs of the process.
+std::shared_ptr<std::timed_mutex> getThreadLock(const std::string &Path) {
+  static std::mutex Mutex;
+  static std::unordered_map<std::string, std::weak_ptr<std::timed_mutex>>
+      Locks;
+  std::lock_guard<std::mutex> Guard(Mutex);
+  auto &Weak = Locks[Path];
+  auto Lock = Weak.lock();
+  if (!Lock) {
+    Lock = std::make_shared<std::timed_mutex>();
+    Weak = Lock;
+  }
+  return Lock;
+}
+} // namespace
+
+CompileLock::CompileLock(const std::string &Path)
+    : LockPath(Path + ".lock"), ThreadLock(getThreadLock(Path)) {}
+
+bool CompileLock::acquire(std::chrono::milliseconds Timeout) {
+  using Clock = std::chrono::steady_clock;
+  const auto Deadline = Clock::now() + Timeout;
+
+  if (!ThreadLock->try_lock_until(Deadline)) {
+    return false;
+  }
+  ThreadLocked = true;
+
+  Fd = open(LockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (Fd < 0) {
+    // Cannot coordinate with other processes, compile anyway
+    return true;
+  }
+  /// flock() has no timed variant, poll it.
+  while (flock(Fd, LOCK_EX | LOCK_NB) != 0) {
+    if (errno != EWOULDBLOCK && errno != EINTR) {
+      // flock() is not supported by the filesystem, only the in-process
+      // guard is left
+      close(Fd);
+      Fd = -1;
+      return true;
+    }
+    if (Clock::now() >= Deadline) {
+      release();
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return true;
+}
+
+void CompileLock::release() {
+  if (Fd >= 0) {
+    flock(Fd, LOCK_UN);
+    close(Fd);
+    Fd = -1;
+  }
+  if (ThreadLocked) {
+    ThreadLock->unlock();
+    ThreadLocked = false;
+  }
+}
+
+} // namespace NAPI
+} // namespace WASMEDGE
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+/// Single-flight guard for compiling one AOT cache entry.
+///
+/// VMs of the same process wait on an in-process mutex, other processes
+/// (e.g. cluster workers) wait on an flock() of `<Path>.lock`. The holder
+/// should check the cache again after acquiring, because the previous holder
+/// has most likely produced the entry already.
+class CompileLock {
+private:
+  std::string LockPath;
+  std::shared_ptr<std::timed_mutex> ThreadLock;
+  bool ThreadLocked = false;
+  int Fd = -1;
+
+public:
+  explicit CompileLock(const std::string &Path);
+  CompileLock(const CompileLock &) = delete;
+  CompileLock &operator=(const CompileLock &) = delete;
+  ~CompileLock() { release(); }
+
+  /// Return false if the lock cannot be acquired within Timeout.
+  bool acquire(std::chrono::milliseconds Timeout);
+  void release();
+};
+
+} // namespace NAPI
+} // namespace WASMEDGE
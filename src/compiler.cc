@@ -0,0 +1,125 @@
+#include "compiler.h"
+#include "compilelock.h"
+#include "instance.h"
+#include "utils.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <map>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+namespace {
+
+WasmEdge_CompilerOptimizationLevel
+toOptimizationLevel(const std::string &Level) {
+  static const std::map<std::string, WasmEdge_CompilerOptimizationLevel>
+      Levels = {{"O0", WasmEdge_CompilerOptimizationLevel_O0},
+                {"O1", WasmEdge_CompilerOptimizationLevel_O1},
+                {"O2", WasmEdge_CompilerOptimizationLevel_O2},
+                {"O3", WasmEdge_CompilerOptimizationLevel_O3},
+                {"Os", WasmEdge_CompilerOptimizationLevel_Os},
+                {"Oz", WasmEdge_CompilerOptimizationLevel_Oz}};
+  return Levels.at(Level);
+}
+
+} // namespace
+
+bool compileToCache(Bytecode &BC, Cache &Cache, const Options &Options,
+                    bool &WaitExpired, bool *Compiled) {
+  if (Compiled) {
+    *Compiled = false;
+  }
+  /// Calculate hash and path.
+  Cache.init(BC.getData(), Options.getCompilerConfigKey());
+
+  /// If the compiled bytecode existed, return directly.
+  if (!Cache.isCached()) {
+    /// Only one VM or process compiles a cache entry, the others wait for it.
+    /// Once a wait has timed out, do not block the following calls again.
+    CompileLock Lock(Cache.getPath());
+    std::chrono::milliseconds Timeout(
+        WaitExpired ? 0 : Options.getAOTCompileTimeout());
+    if (!Lock.acquire(Timeout)) {
+      if (!WaitExpired) {
+        std::cerr << "WasmEdge Compile: timed out waiting for "
+                  << Cache.getPath() << ", using the interpreter.\n";
+        WaitExpired = true;
+      }
+      return false;
+    }
+    WaitExpired = false;
+
+    if (!Cache.isCached()) {
+      /// Cache not found. Compile wasm bytecode into a private file and
+      /// publish it with rename(), so a partial file is never seen as cached.
+      const std::string &Path = Cache.getPath();
+      std::string TmpPath =
+          Cache::getTmpPath(Path.substr(0, Path.size() - 3), ".so");
+      if (!compileBytecodeTo(BC, Options, TmpPath) ||
+          std::rename(TmpPath.c_str(), Path.c_str()) != 0) {
+        std::remove(TmpPath.c_str());
+        return false;
+      }
+      if (Compiled) {
+        *Compiled = true;
+      }
+    }
+  }
+
+  /// After compiled Bytecode, the output will be written to a FilePath.
+  BC.setPath(Cache.getPath());
+  return true;
+}
+
+bool compileBytecodeTo(Bytecode &BC, const Options &Options,
+                       const std::string &Path) {
+  /// Make sure BC is in FilePath mode
+  BC.setFileMode();
+
+  /// The compiler has its own configuration, Compile() can be called before
+  /// the VM is created.
+  WasmEdge_ConfigureContext *CompilerConf = WasmEdge_ConfigureCreate();
+  addProposals(CompilerConf, Options.isThreadsEnabled());
+  if (Options.isMeasuring()) {
+    WasmEdge_ConfigureCompilerSetCostMeasuring(CompilerConf, true);
+    WasmEdge_ConfigureCompilerSetInstructionCounting(CompilerConf, true);
+  }
+  if (!Options.getAOTOptLevel().empty()) {
+    WasmEdge_ConfigureCompilerSetOptimizationLevel(
+        CompilerConf, toOptimizationLevel(Options.getAOTOptLevel()));
+  }
+#if WASMEDGE_NAPI_VERSION_AT_LEAST(0, 8, 2)
+  WasmEdge_ConfigureCompilerSetGenericBinary(CompilerConf,
+                                             Options.isAOTGenericBinary());
+#else
+  if (Options.isAOTGenericBinary()) {
+    std::cerr << "WasmEdge Compile: generic binaries require WasmEdge >= "
+                 "0.8.2, compiling for the native CPU.\n";
+  }
+#endif
+
+  auto Start = std::chrono::steady_clock::now();
+  WasmEdge_CompilerContext *CompilerCxt = WasmEdge_CompilerCreate(CompilerConf);
+  WasmEdge_Result Res =
+      WasmEdge_CompilerCompile(CompilerCxt, BC.getPath().c_str(), Path.c_str());
+  WasmEdge_CompilerDelete(CompilerCxt);
+  WasmEdge_ConfigureDelete(CompilerConf);
+  if (!WasmEdge_ResultOK(Res)) {
+    std::cerr << "WasmEdge Compile failed. Error: "
+              << WasmEdge_ResultGetMessage(Res);
+    return false;
+  }
+  if (Options.isAOTDumpCompileTime()) {
+    auto Elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - Start);
+    std::cerr << "WasmEdge Compile: " << BC.getPath() << " -> " << Path
+              << " took " << Elapsed.count() << " ms\n";
+  }
+  return true;
+}
+
+} // namespace NAPI
+} // namespace WASMEDGE
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "bytecode.h"
+#include "cache.h"
+#include "options.h"
+
+#include <string>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+/// Compile BC into its AOT cache entry unless it is cached already, and point
+/// BC to the compiled file. Only one VM or process compiles an entry, the
+/// others wait up to the AOTCompileTimeout option; WaitExpired records a wait
+/// which timed out so that the next calls do not block again. Compiled, when
+/// given, tells whether this call compiled the entry itself.
+bool compileToCache(Bytecode &BC, Cache &Cache, const Options &Options,
+                    bool &WaitExpired, bool *Compiled = nullptr);
+
+/// Compile BC into the file at Path with the compiler options.
+bool compileBytecodeTo(Bytecode &BC, const Options &Options,
+                       const std::string &Path);
+
+} // namespace NAPI
+} // namespace WASMEDGE
@@ -0,0 +1,137 @@
+#include "dependency.h"
+
+#include <boost/functional/hash.hpp>
+#include <mutex>
+#include <unordered_map>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+namespace {
+
+/// Process-wide table of the prepared dependencies, keyed by their bytes and
+/// the configuration they have been compiled with. Entries are kept for the
+/// lifetime of the process, like the files of the AOT cache.
+class DependencyRegistry {
+private:
+  struct Entry {
+    std::mutex Mutex;
+    std::shared_ptr<const SharedModule> Module;
+  };
+  std::mutex Mutex;
+  std::unordered_map<std::string, std::shared_ptr<Entry>> Entries;
+
+public:
+  static DependencyRegistry &getInstance() {
+    static DependencyRegistry Registry;
+    return Registry;
+  }
+
+  std::string get(Bytecode BC, const Options &Options,
+                  std::shared_ptr<const SharedModule> &Module) {
+    const std::vector<uint8_t> &Data = BC.getData();
+    size_t Hash = boost::hash_range(Data.begin(), Data.end());
+    std::string Key = std::to_string(Hash) + "/" + std::to_string(Data.size()) +
+                      "/" + Options.getCompilerConfigKey() +
+                      (Options.isAOTMode() ? "/aot" : "") +
+                      (Options.isThreadsEnabled() ? "/threads" : "");
+    std::shared_ptr<Entry> E;
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      auto &Slot = Entries[Key];
+      if (!Slot) {
+        Slot = std::make_shared<Entry>();
+      }
+      E = Slot;
+    }
+    /// Other VMs needing the same module wait for the first one to prepare
+    /// it, while other modules are prepared meanwhile
+    std::lock_guard<std::mutex> Lock(E->Mutex);
+    if (!E->Module) {
+      auto Prepared = std::make_shared<SharedModule>();
+      Prepared->BC.setData(Data);
+      bool Compiled;
+      if (auto Err = prepareSharedModule(*Prepared, Options, Compiled);
+          !Err.empty()) {
+        return Err;
+      }
+      E->Module = std::move(Prepared);
+    }
+    Module = E->Module;
+    return {};
+  }
+};
+
+} // namespace
+
+std::string resolveDependencies(
+    const std::map<std::string, DependencySource> &Sources,
+    const Options &Options, std::vector<Dependency> &Deps) {
+  Deps.clear();
+  for (const auto &[Name, Source] : Sources) {
+    Bytecode BC;
+    if (!Source.Path.empty()) {
+      BC.setPath(Source.Path);
+      if (BC.getData().size() < 4) {
+        return Name + ": cannot read " + Source.Path;
+      }
+    } else if (Source.Data.size() >= 4) {
+      BC.setData(Source.Data);
+    } else {
+      return Name + ": not a wasm module";
+    }
+    Dependency Dep;
+    Dep.Name = Name;
+    if (auto Err =
+            DependencyRegistry::getInstance().get(BC, Options, Dep.Module);
+        !Err.empty()) {
+      return Name + ": " + Err;
+    }
+    Deps.push_back(std::move(Dep));
+  }
+  return {};
+}
+
+std::string registerDependencies(WasmEdge_VMContext *VM,
+                                 const std::vector<Dependency> &Deps) {
+  /// A dependency importing another one must come after it. The imports of
+  /// AOT compiled input are unknown, so retry the failed ones as long as
+  /// some other dependency gets registered.
+  std::vector<const Dependency *> Pending;
+  for (const auto &Dep : Deps) {
+    Pending.push_back(&Dep);
+  }
+  std::string Error;
+  while (!Pending.empty()) {
+    std::vector<const Dependency *> Failed;
+    for (const Dependency *Dep : Pending) {
+      WasmEdge_String Name = WasmEdge_StringCreateByCString(Dep->Name.c_str());
+      WasmEdge_Result Res = WasmEdge_VMRegisterModuleFromASTModule(
+          VM, Name, Dep->Module->AST.get());
+      WasmEdge_StringDelete(Name);
+      if (!WasmEdge_ResultOK(Res)) {
+        Failed.push_back(Dep);
+        Error = Dep->Name + ": " + WasmEdge_ResultGetMessage(Res);
+      }
+    }
+    if (Failed.size() == Pending.size()) {
+      return Error;
+    }
+    Pending = std::move(Failed);
+  }
+  return {};
+}
+
+bool collectDependencyImports(const std::vector<Dependency> &Deps,
+                              std::set<std::string> &Names) {
+  bool Known = true;
+  for (const auto &Dep : Deps) {
+    Names.insert(Dep.Module->ImportModules.begin(),
+                 Dep.Module->ImportModules.end());
+    Known = Known && Dep.Module->ImportsKnown;
+  }
+  return Known;
+}
+
+} // namespace NAPI
+} // namespace WASMEDGE
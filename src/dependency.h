@@ -0,0 +1,42 @@
+#pragma once
+
+#include "options.h"
+#include "sharedmodule.h"
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include <wasmedge.h>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+/// A module of the Dependencies option. The module is loaded, AOT compiled
+/// when enabled and validated once per process, then every VM and instance
+/// importing it registers its own instance from the same AST.
+struct Dependency {
+  std::string Name;
+  std::shared_ptr<const SharedModule> Module;
+};
+
+/// Prepare the modules of Sources, reusing the ones prepared earlier by any
+/// VM of the process with the same bytes and compiler configuration. Return
+/// an error message, empty on success.
+std::string resolveDependencies(
+    const std::map<std::string, DependencySource> &Sources,
+    const Options &Options, std::vector<Dependency> &Deps);
+
+/// Register the dependencies into VM, each one after the dependencies it
+/// imports. Return an error message, empty on success.
+std::string registerDependencies(WasmEdge_VMContext *VM,
+                                 const std::vector<Dependency> &Deps);
+
+/// Add the module names imported by the dependencies, return false when
+/// some of them cannot be known
+bool collectDependencyImports(const std::vector<Dependency> &Deps,
+                              std::set<std::string> &Names);
+
+} // namespace NAPI
+} // namespace WASMEDGE
@@ -21,7 +21,27 @@ enum class ErrorType {
   InitReactorFailed,
   WasmBindgenMallocFailed,
   WasmBindgenFreeFailed,
-  NAPIUnkownIntType
+  NAPIUnkownIntType,
+  InvalidSharedModule,
+  CompileWasmFailed,
+  RegisterHostFunctionsFailed,
+  InvalidPipelineSteps,
+  StreamInProgress,
+  StreamNotStarted,
+  MountMemFSFailed,
+  CaptureOutputFailed,
+  EncodeMsgPackFailed,
+  DecodeMsgPackFailed,
+  InvalidParallelInputs,
+  InvalidSwapModule,
+  GasLimitExceeded,
+  InvalidGasLimit,
+  GasMeteringDisabled,
+  InvalidSessionArguments,
+  InvalidAsyncCall,
+  InvalidTenantPolicy,
+  LoadDependencyFailed,
+  OpenRecordFailed
 };
 
 const std::map<ErrorType, std::string> ErrorMsgs = {
@@ -48,7 +68,55 @@ const std::map<ErrorType, std::string> ErrorMsgs = {
      "Failed to call wasm-bindgen helper function __wbindgen_free"},
     {ErrorType::NAPIUnkownIntType,
      "WASMEDGE-Napi implementation error: unknown integer type"},
-    {ErrorType::UnsupportedArgumentType, "Unsupported argument type"}};
+    {ErrorType::UnsupportedArgumentType, "Unsupported argument type"},
+    {ErrorType::InvalidSharedModule,
+     "Shared module handle is invalid or has been released."},
+    {ErrorType::CompileWasmFailed,
+     "Wasm bytecode/file cannot be compiled by the AOT compiler."},
+    {ErrorType::RegisterHostFunctionsFailed,
+     "Failed to register the host functions given by the imports option."},
+    {ErrorType::InvalidPipelineSteps,
+     "Pipeline steps must be a non-empty array of function names or "
+     "{ name, args } objects."},
+    {ErrorType::StreamInProgress,
+     "A stream is in progress on this VM, call StreamEnd() first."},
+    {ErrorType::StreamNotStarted,
+     "No stream is in progress on this VM, call StreamBegin() first."},
+    {ErrorType::MountMemFSFailed,
+     "Failed to prepare the in-memory filesystem given by the memfs option."},
+    {ErrorType::CaptureOutputFailed,
+     "Failed to redirect stdout and stderr into memory."},
+    {ErrorType::EncodeMsgPackFailed,
+     "Argument cannot be encoded as MessagePack (functions, symbols or "
+     "too deeply nested data)."},
+    {ErrorType::DecodeMsgPackFailed,
+     "Result of the wasm function is not a valid MessagePack value."},
+    {ErrorType::InvalidParallelInputs,
+     "RunParallel expects a function name and an array of strings or "
+     "Uint8Arrays."},
+    {ErrorType::InvalidSwapModule,
+     "SwapModule expects a Wasm file path or a Wasm binary sequence."},
+    {ErrorType::GasLimitExceeded,
+     "Execution aborted, the gas limit of the call has been exceeded."},
+    {ErrorType::InvalidGasLimit,
+     "Gas limit must be a non-negative integer, 0 for unlimited."},
+    {ErrorType::GasMeteringDisabled,
+     "SetGasLimit needs gas metering, enable it with the EnableMeasurement, "
+     "GasLimit or CostTable option."},
+    {ErrorType::InvalidSessionArguments,
+     "Session calls expect a key, a function name and a string or an "
+     "Uint8Array."},
+    {ErrorType::InvalidAsyncCall,
+     "RunAsync expects a function name, a string or an Uint8Array and "
+     "optional { Tenant, Priority } options with a Priority from 0 to 2."},
+    {ErrorType::InvalidTenantPolicy,
+     "Tenant policy must be { Weight, MaxConcurrency } with a positive "
+     "Weight."},
+    {ErrorType::LoadDependencyFailed,
+     "A module of the Dependencies option cannot be loaded, validated or "
+     "linked."},
+    {ErrorType::OpenRecordFailed,
+     "The log file of the Record option cannot be opened."}};
 
 } // namespace NAPI
 } // namespace WASMEDGE
@@ -0,0 +1,498 @@
+#include "hostfunction.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <future>
+#include <map>
+#include <mutex>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+namespace {
+
+using ValType = HostFunction::ValType;
+
+bool parseValType(const Napi::Value &Value, ValType &Type) {
+  if (!Value.IsString()) {
+    return false;
+  }
+  static const std::map<std::string, ValType> ValTypes = {
+      {"i32", ValType::I32},       {"i64", ValType::I64},
+      {"f32", ValType::F32},       {"f64", ValType::F64},
+      {"string", ValType::String}, {"bytes", ValType::Bytes}};
+  if (auto It = ValTypes.find(Value.As<Napi::String>().Utf8Value());
+      It != ValTypes.end()) {
+    Type = It->second;
+    return true;
+  }
+  return false;
+}
+
+bool parseValTypes(std::vector<ValType> &Types, const Napi::Object &Desc,
+                   const std::string &Key) {
+  Types.clear();
+  if (!Desc.Has(Key)) {
+    return true;
+  }
+  if (!Desc.Get(Key).IsArray()) {
+    return false;
+  }
+  Napi::Array List = Desc.Get(Key).As<Napi::Array>();
+  for (uint32_t I = 0; I < List.Length(); I++) {
+    ValType Type;
+    if (!parseValType(List[I], Type)) {
+      return false;
+    }
+    Types.push_back(Type);
+  }
+  return true;
+}
+
+inline bool isNumeric(ValType Type) {
+  return Type != ValType::String && Type != ValType::Bytes;
+}
+
+void appendWasmTypes(std::vector<WasmEdge_ValType> &List, ValType Type) {
+  switch (Type) {
+  case ValType::I32:
+    List.push_back(WasmEdge_ValType_I32);
+    break;
+  case ValType::I64:
+    List.push_back(WasmEdge_ValType_I64);
+    break;
+  case ValType::F32:
+    List.push_back(WasmEdge_ValType_F32);
+    break;
+  case ValType::F64:
+    List.push_back(WasmEdge_ValType_F64);
+    break;
+  case ValType::String:
+  case ValType::Bytes:
+    // (pointer, length) in the guest linear memory
+    List.push_back(WasmEdge_ValType_I32);
+    List.push_back(WasmEdge_ValType_I32);
+    break;
+  }
+}
+
+Napi::Value toJSNumber(Napi::Env Env, ValType Type,
+                       const WasmEdge_Value &Value) {
+  switch (Type) {
+  case ValType::I64:
+    return Napi::BigInt::New(Env, WasmEdge_ValueGetI64(Value));
+  case ValType::F32:
+    return Napi::Number::New(Env, WasmEdge_ValueGetF32(Value));
+  case ValType::F64:
+    return Napi::Number::New(Env, WasmEdge_ValueGetF64(Value));
+  default:
+    return Napi::Number::New(Env, WasmEdge_ValueGetI32(Value));
+  }
+}
+
+Napi::Value toJSData(Napi::Env Env, ValType Type, const uint8_t *Data,
+                     uint32_t Length) {
+  if (Type == ValType::String) {
+    return Napi::String::New(Env, reinterpret_cast<const char *>(Data),
+                             Length);
+  }
+  Napi::ArrayBuffer Buffer = Napi::ArrayBuffer::New(Env, Length);
+  if (Length > 0) {
+    std::memcpy(Buffer.Data(), Data, Length);
+  }
+  return Napi::Uint8Array::New(Env, Length, Buffer, 0, napi_uint8_array);
+}
+
+bool fromJSNumber(const Napi::Value &Value, ValType Type,
+                  WasmEdge_Value &Out) {
+  if (Type == ValType::I64 && Value.IsBigInt()) {
+    bool Lossless;
+    Out = WasmEdge_ValueGenI64(Value.As<Napi::BigInt>().Int64Value(&Lossless));
+    return true;
+  }
+  if (!Value.IsNumber()) {
+    return false;
+  }
+  Napi::Number Number = Value.As<Napi::Number>();
+  switch (Type) {
+  case ValType::I32:
+    Out = WasmEdge_ValueGenI32(Number.Int32Value());
+    return true;
+  case ValType::I64:
+    Out = WasmEdge_ValueGenI64(Number.Int64Value());
+    return true;
+  case ValType::F32:
+    Out = WasmEdge_ValueGenF32(Number.FloatValue());
+    return true;
+  case ValType::F64:
+    Out = WasmEdge_ValueGenF64(Number.DoubleValue());
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool fromJSResults(const Napi::Value &Value, const std::vector<ValType> &Types,
+                   WasmEdge_Value *Out) {
+  if (Types.empty()) {
+    return true;
+  }
+  if (Types.size() == 1) {
+    return fromJSNumber(Value, Types[0], Out[0]);
+  }
+  // Multiple results are returned as an array
+  if (!Value.IsArray() || Value.As<Napi::Array>().Length() != Types.size()) {
+    return false;
+  }
+  Napi::Array List = Value.As<Napi::Array>();
+  for (uint32_t I = 0; I < Types.size(); I++) {
+    if (!fromJSNumber(List[I], Types[I], Out[I])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Arguments of a call which is forwarded to the JS thread.
+struct ThreadSafeCall {
+  std::vector<WasmEdge_Value> In;
+  /// Linear memory may change once the guest resumes, so the string and
+  /// bytes arguments are copied on the calling thread.
+  std::vector<std::vector<uint8_t>> Data;
+  std::vector<WasmEdge_Value> Out;
+  std::promise<bool> Done;
+};
+
+/// Calls forwarded to the JS thread by one wasm execution, see
+/// HostFunction::beginForwarding().
+class ForwardedCalls {
+private:
+  std::mutex Mutex;
+  std::condition_variable Idle;
+  uint32_t Pending = 0;
+  std::string Error;
+
+public:
+  void add() {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    ++Pending;
+  }
+  /// The call ran, Err is the message of its exception if it threw
+  void done(std::string Err) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (Error.empty()) {
+      Error = std::move(Err);
+    }
+    if (--Pending == 0) {
+      Idle.notify_all();
+    }
+  }
+  bool failed() {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return !Error.empty();
+  }
+  std::string wait() {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    Idle.wait(Lock, [this]() { return Pending == 0; });
+    return std::move(Error);
+  }
+};
+
+thread_local std::shared_ptr<ForwardedCalls> CurrentCalls;
+
+} // namespace
+
+HostFunction::~HostFunction() {
+  if (TSFN) {
+    TSFN.Release();
+  }
+}
+
+bool HostFunction::parse(const std::string &Module, const std::string &Name,
+                         const Napi::Object &Desc) {
+  Sig->ModuleName = Module;
+  Sig->FuncName = Name;
+  std::vector<ValType> &Params = Sig->Params;
+  std::vector<ValType> &Results = Sig->Results;
+  if (!Desc.Has(kImportFuncString) ||
+      !Desc.Get(kImportFuncString).IsFunction()) {
+    return false;
+  }
+  if (!parseValTypes(Params, Desc, kImportParamsString) ||
+      !parseValTypes(Results, Desc, kImportResultsString)) {
+    return false;
+  }
+  for (auto Type : Results) {
+    if (!isNumeric(Type)) {
+      // Only wasm value types can be returned
+      return false;
+    }
+  }
+  Argv.resize(Params.size());
+
+  Napi::Function Func = Desc.Get(kImportFuncString).As<Napi::Function>();
+  Callback = Napi::Persistent(Func);
+  TSFN = Napi::ThreadSafeFunction::New(Desc.Env(), Func, "WasmEdgeHostFunction",
+                                       kMaxQueuedCalls, 1);
+  // Do not keep the event loop alive for host functions
+  TSFN.Unref(Desc.Env());
+  JSThread = std::this_thread::get_id();
+  return true;
+}
+
+WasmEdge_HostFunctionContext *HostFunction::createContext() {
+  std::vector<WasmEdge_ValType> ParamTypes, ResultTypes;
+  for (auto Type : Sig->Params) {
+    appendWasmTypes(ParamTypes, Type);
+  }
+  for (auto Type : Sig->Results) {
+    appendWasmTypes(ResultTypes, Type);
+  }
+  WasmEdge_FunctionTypeContext *FuncType =
+      WasmEdge_FunctionTypeCreate(ParamTypes.data(), ParamTypes.size(),
+                                  ResultTypes.data(), ResultTypes.size());
+  WasmEdge_HostFunctionContext *HostFunc =
+      WasmEdge_HostFunctionCreateBinding(FuncType, &HostFunction::wrap, this,
+                                         0);
+  WasmEdge_FunctionTypeDelete(FuncType);
+  return HostFunc;
+}
+
+WasmEdge_Result HostFunction::wrap(void *This, void *,
+                                   WasmEdge_MemoryInstanceContext *MemCxt,
+                                   const WasmEdge_Value *Params,
+                                   const uint32_t, WasmEdge_Value *Returns,
+                                   const uint32_t) {
+  HostFunction *Func = static_cast<HostFunction *>(This);
+  if (std::this_thread::get_id() == Func->JSThread) {
+    return Func->call(MemCxt, Params, Returns);
+  }
+  return Func->callThreadSafe(MemCxt, Params, Returns);
+}
+
+WasmEdge_Result HostFunction::call(WasmEdge_MemoryInstanceContext *MemCxt,
+                                   const WasmEdge_Value *In,
+                                   WasmEdge_Value *Out) {
+  Napi::Env Env = Callback.Env();
+  Napi::HandleScope Scope(Env);
+  const std::vector<ValType> &Params = Sig->Params;
+
+  /// Argv is reused by every call, numeric parameters never touch the memory
+  uint32_t WasmIdx = 0;
+  for (size_t I = 0; I < Params.size(); I++) {
+    if (isNumeric(Params[I])) {
+      Argv[I] = toJSNumber(Env, Params[I], In[WasmIdx++]);
+      continue;
+    }
+    uint32_t Addr = static_cast<uint32_t>(WasmEdge_ValueGetI32(In[WasmIdx]));
+    uint32_t Len = static_cast<uint32_t>(WasmEdge_ValueGetI32(In[WasmIdx + 1]));
+    WasmIdx += 2;
+    const uint8_t *Data =
+        WasmEdge_MemoryInstanceGetPointerConst(MemCxt, Addr, Len);
+    if (Data == nullptr && Len > 0) {
+      return WasmEdge_Result_Fail;
+    }
+    Argv[I] = toJSData(Env, Params[I], Data, Len);
+  }
+
+  Napi::Value Ret = Callback.Call(Argv);
+  if (Env.IsExceptionPending()) {
+    // The JS exception is rethrown when the execution returns
+    return WasmEdge_Result_Fail;
+  }
+  if (!fromJSResults(Ret, Sig->Results, Out)) {
+    return WasmEdge_Result_Fail;
+  }
+  return WasmEdge_Result_Success;
+}
+
+WasmEdge_Result
+HostFunction::callThreadSafe(WasmEdge_MemoryInstanceContext *MemCxt,
+                             const WasmEdge_Value *In, WasmEdge_Value *Out) {
+  std::shared_ptr<ForwardedCalls> Calls = CurrentCalls;
+  if (Calls && Calls->failed()) {
+    /// A queued call of this execution has thrown, trap the guest
+    return WasmEdge_Result_Fail;
+  }
+  auto Call = std::make_unique<ThreadSafeCall>();
+  uint32_t WasmIdx = 0;
+  for (auto Type : Sig->Params) {
+    if (isNumeric(Type)) {
+      Call->In.push_back(In[WasmIdx++]);
+      continue;
+    }
+    uint32_t Addr = static_cast<uint32_t>(WasmEdge_ValueGetI32(In[WasmIdx]));
+    uint32_t Len = static_cast<uint32_t>(WasmEdge_ValueGetI32(In[WasmIdx + 1]));
+    WasmIdx += 2;
+    const uint8_t *Data =
+        WasmEdge_MemoryInstanceGetPointerConst(MemCxt, Addr, Len);
+    if (Data == nullptr && Len > 0) {
+      return WasmEdge_Result_Fail;
+    }
+    Call->Data.emplace_back(Data, Data + Len);
+  }
+  Call->Out.resize(Sig->Results.size());
+
+  /// Only shared state is captured, the queued call may run after the
+  /// HostFunction is gone
+  auto Invoke = [Sig = Sig, Calls](Napi::Env Env, Napi::Function JSCallback,
+                                   ThreadSafeCall *Call) {
+    Napi::HandleScope Scope(Env);
+    std::vector<napi_value> Args;
+    Args.reserve(Sig->Params.size());
+    size_t NumIdx = 0, DataIdx = 0;
+    for (auto Type : Sig->Params) {
+      if (isNumeric(Type)) {
+        Args.push_back(toJSNumber(Env, Type, Call->In[NumIdx++]));
+      } else {
+        const auto &Data = Call->Data[DataIdx++];
+        Args.push_back(toJSData(Env, Type, Data.data(), Data.size()));
+      }
+    }
+    Napi::Value Ret = JSCallback.Call(Args);
+    bool OK = true;
+    std::string Error;
+    if (Env.IsExceptionPending()) {
+      // No JS frame is waiting for this call, report it through the guest
+      Napi::Value Thrown = Env.GetAndClearPendingException().Value();
+      std::string Message = Thrown.ToString().Utf8Value();
+      if (Env.IsExceptionPending()) {
+        Env.GetAndClearPendingException();
+        Message = "exception";
+      }
+      Error = Sig->ModuleName + "." + Sig->FuncName + ": " + Message;
+      OK = false;
+    } else {
+      OK = fromJSResults(Ret, Sig->Results, Call->Out.data());
+    }
+    if (Calls) {
+      Calls->done(std::move(Error));
+    }
+    Call->Done.set_value(OK);
+  };
+
+  if (Calls) {
+    Calls->add();
+  }
+  if (Sig->Results.empty()) {
+    // Nothing to wait for: queue the call and let the event loop deliver
+    // the pending calls in batches. Only blocks while the queue is full.
+    ThreadSafeCall *Pending = Call.release();
+    napi_status Status = TSFN.BlockingCall(
+        Pending, [Invoke](Napi::Env Env, Napi::Function JSCallback,
+                          ThreadSafeCall *Call) {
+          Invoke(Env, JSCallback, Call);
+          delete Call;
+        });
+    if (Status != napi_ok) {
+      delete Pending;
+      if (Calls) {
+        Calls->done({});
+      }
+      return WasmEdge_Result_Fail;
+    }
+    return WasmEdge_Result_Success;
+  }
+
+  std::future<bool> Done = Call->Done.get_future();
+  if (TSFN.BlockingCall(Call.get(), Invoke) != napi_ok) {
+    if (Calls) {
+      Calls->done({});
+    }
+    return WasmEdge_Result_Fail;
+  }
+  if (!Done.get()) {
+    return WasmEdge_Result_Fail;
+  }
+  std::copy(Call->Out.begin(), Call->Out.end(), Out);
+  return WasmEdge_Result_Success;
+}
+
+void HostFunction::beginForwarding() {
+  CurrentCalls = std::make_shared<ForwardedCalls>();
+}
+
+std::string HostFunction::endForwarding() {
+  std::shared_ptr<ForwardedCalls> Calls = std::move(CurrentCalls);
+  return Calls ? Calls->wait() : std::string();
+}
+
+bool HostModules::parse(const Napi::Object &Options) {
+  Funcs.clear();
+  if (!Options.Has(kImportsString)) {
+    return true;
+  }
+  if (!Options.Get(kImportsString).IsObject()) {
+    return false;
+  }
+  // Format: { <module_name>: { <func_name>: { params, results, func } } }
+  Napi::Object Imports = Options.Get(kImportsString).As<Napi::Object>();
+  Napi::Array ModNames = Imports.GetPropertyNames();
+  for (uint32_t I = 0; I < ModNames.Length(); I++) {
+    Napi::Value ModName = ModNames[I];
+    Napi::Value Module = Imports.Get(ModName);
+    if (!ModName.IsString() || !Module.IsObject()) {
+      return false;
+    }
+    Napi::Array FuncNames = Module.As<Napi::Object>().GetPropertyNames();
+    for (uint32_t J = 0; J < FuncNames.Length(); J++) {
+      Napi::Value FuncName = FuncNames[J];
+      Napi::Value Desc = Module.As<Napi::Object>().Get(FuncName);
+      if (!FuncName.IsString() || !Desc.IsObject()) {
+        return false;
+      }
+      auto Func = std::make_unique<HostFunction>();
+      if (!Func->parse(ModName.As<Napi::String>().Utf8Value(),
+                       FuncName.As<Napi::String>().Utf8Value(),
+                       Desc.As<Napi::Object>())) {
+        return false;
+      }
+      Funcs.push_back(std::move(Func));
+    }
+  }
+  return true;
+}
+
+bool HostModules::registerTo(WasmEdge_VMContext *VM) {
+  releaseImportObjects();
+  return registerTo(VM, ImportObjs);
+}
+
+bool HostModules::registerTo(
+    WasmEdge_VMContext *VM,
+    std::vector<WasmEdge_ImportObjectContext *> &Owned) {
+  std::map<std::string, WasmEdge_ImportObjectContext *> ByName;
+  for (auto &Func : Funcs) {
+    WasmEdge_ImportObjectContext *&ImportObj = ByName[Func->getModuleName()];
+    if (ImportObj == nullptr) {
+      WasmEdge_String ModName =
+          WasmEdge_StringCreateByCString(Func->getModuleName().c_str());
+      ImportObj = WasmEdge_ImportObjectCreate(ModName, nullptr);
+      WasmEdge_StringDelete(ModName);
+      Owned.push_back(ImportObj);
+    }
+    WasmEdge_String FuncName =
+        WasmEdge_StringCreateByCString(Func->getFuncName().c_str());
+    // The import object takes the ownership of the host function context
+    WasmEdge_ImportObjectAddHostFunction(ImportObj, FuncName,
+                                         Func->createContext());
+    WasmEdge_StringDelete(FuncName);
+  }
+  for (auto *ImportObj : Owned) {
+    WasmEdge_Result Res = WasmEdge_VMRegisterModuleFromImport(VM, ImportObj);
+    if (!WasmEdge_ResultOK(Res)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void HostModules::releaseImportObjects() {
+  for (auto *ImportObj : ImportObjs) {
+    WasmEdge_ImportObjectDelete(ImportObj);
+  }
+  ImportObjs.clear();
+}
+
+} // namespace NAPI
+} // namespace WASMEDGE
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <napi.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include <wasmedge.h>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+static inline std::string kImportsString [[maybe_unused]] = "imports";
+static inline std::string kImportParamsString [[maybe_unused]] = "params";
+static inline std::string kImportResultsString [[maybe_unused]] = "results";
+static inline std::string kImportFuncString [[maybe_unused]] = "func";
+
+/// A JS function registered as a WasmEdge host function.
+///
+/// Besides the wasm value types, parameters can be declared as `string` or
+/// `bytes`. Such a parameter takes two i32 values (pointer, length) from the
+/// guest and is passed to JS as a String or an Uint8Array.
+///
+/// Calls from other threads are forwarded to the JS thread. Calls without
+/// results are queued without waiting for them, up to kMaxQueuedCalls; the
+/// calling thread blocks while the queue is full. The execution which made
+/// the calls waits for them in endForwarding(), which returns the first JS
+/// exception they threw.
+class HostFunction {
+public:
+  enum class ValType { I32, I64, F32, F64, String, Bytes };
+
+private:
+  /// Shared with the queued calls, which may run after this is destroyed
+  struct Signature {
+    std::string ModuleName;
+    std::string FuncName;
+    std::vector<ValType> Params;
+    std::vector<ValType> Results;
+  };
+  std::shared_ptr<Signature> Sig = std::make_shared<Signature>();
+  Napi::FunctionReference Callback;
+  /// Used when the wasm function calls back from a thread other than the JS
+  /// thread which created this host function.
+  Napi::ThreadSafeFunction TSFN;
+  std::thread::id JSThread;
+  std::vector<napi_value> Argv;
+
+  WasmEdge_Result call(WasmEdge_MemoryInstanceContext *MemCxt,
+                       const WasmEdge_Value *In, WasmEdge_Value *Out);
+  WasmEdge_Result callThreadSafe(WasmEdge_MemoryInstanceContext *MemCxt,
+                                 const WasmEdge_Value *In, WasmEdge_Value *Out);
+
+public:
+  static constexpr size_t kMaxQueuedCalls = 256;
+
+  HostFunction() = default;
+  HostFunction(const HostFunction &) = delete;
+  HostFunction &operator=(const HostFunction &) = delete;
+  ~HostFunction();
+
+  bool parse(const std::string &Module, const std::string &Name,
+             const Napi::Object &Desc);
+  const std::string &getModuleName() const noexcept {
+    return Sig->ModuleName;
+  }
+  const std::string &getFuncName() const noexcept { return Sig->FuncName; }
+
+  /// Create the WasmEdge host function context. The caller owns the result.
+  WasmEdge_HostFunctionContext *createContext();
+
+  /// Track the calls which the wasm execution on this thread forwards to the
+  /// JS thread, until endForwarding().
+  static void beginForwarding();
+  /// Wait for the calls forwarded since beginForwarding() and return the
+  /// first exception they threw, empty if none.
+  static std::string endForwarding();
+
+  static WasmEdge_Result wrap(void *This, void *Data,
+                              WasmEdge_MemoryInstanceContext *MemCxt,
+                              const WasmEdge_Value *Params,
+                              const uint32_t ParamLen, WasmEdge_Value *Returns,
+                              const uint32_t ReturnLen);
+};
+
+/// All host functions given by the `imports` option, grouped by module name.
+class HostModules {
+private:
+  std::vector<std::unique_ptr<HostFunction>> Funcs;
+  std::vector<WasmEdge_ImportObjectContext *> ImportObjs;
+
+public:
+  ~HostModules() { releaseImportObjects(); }
+
+  bool parse(const Napi::Object &Options);
+  bool empty() const noexcept { return Funcs.empty(); }
+  /// Create one import object per module name and register them in the VM.
+  bool registerTo(WasmEdge_VMContext *VM);
+  /// Same, for a VM owned by someone else, which then owns the import objects.
+  bool registerTo(WasmEdge_VMContext *VM,
+                  std::vector<WasmEdge_ImportObjectContext *> &Owned);
+  /// Import objects must outlive the VM they are registered to.
+  void releaseImportObjects();
+};
+
+} // namespace NAPI
+} // namespace WASMEDGE
@@ -0,0 +1,233 @@
+#include "instance.h"
+
+namespace WASMEDGE {
+namespace NAPI {
+
+void addProposals(WasmEdge_ConfigureContext *Conf, bool Threads) {
+  WasmEdge_ConfigureAddProposal(Conf, WasmEdge_Proposal_MultiValue);
+  WasmEdge_ConfigureAddProposal(Conf, WasmEdge_Proposal_BulkMemoryOperations);
+  WasmEdge_ConfigureAddProposal(Conf, WasmEdge_Proposal_ReferenceTypes);
+  WasmEdge_ConfigureAddProposal(Conf, WasmEdge_Proposal_SIMD);
+  if (Threads) {
+    WasmEdge_ConfigureAddProposal(Conf, WasmEdge_Proposal_Threads);
+  }
+}
+
+bool returnsPtrLen(const WasmEdge_FunctionTypeContext *Type) {
+  if (Type == nullptr || WasmEdge_FunctionTypeGetReturnsLength(Type) != 2) {
+    return false;
+  }
+  enum WasmEdge_ValType Rets[2];
+  WasmEdge_FunctionTypeGetReturns(Type, Rets, 2);
+  return Rets[0] == WasmEdge_ValType_I32 && Rets[1] == WasmEdge_ValType_I32;
+}
+
+Instance::~Instance() {
+  if (VM != nullptr) {
+    WasmEdge_VMDelete(VM);
+  }
+  for (auto *ImportObj : HostImports) {
+    WasmEdge_ImportObjectDelete(ImportObj);
+  }
+  if (Store != nullptr) {
+    WasmEdge_StoreDelete(Store);
+  }
+  if (Configure != nullptr) {
+    WasmEdge_ConfigureDelete(Configure);
+  }
+}
+
+std::string Instance::execute(const char *FuncName,
+                              const WasmEdge_Value *Params, uint32_t ParamLen,
+                              WasmEdge_Value *Rets, uint32_t RetLen) {
+  if (HostMods != nullptr) {
+    HostFunction::beginForwarding();
+  }
+  WasmEdge_String Name = WasmEdge_StringCreateByCString(FuncName);
+  WasmEdge_Result Res =
+      WasmEdge_VMExecute(VM, Name, Params, ParamLen, Rets, RetLen);
+  WasmEdge_StringDelete(Name);
+  /// Calls without results may still be queued, their exceptions fail this
+  /// execution
+  std::string Thrown =
+      HostMods != nullptr ? HostFunction::endForwarding() : std::string();
+  if (!WasmEdge_ResultOK(Res)) {
+    std::string Err =
+        std::string(FuncName) + ": " + WasmEdge_ResultGetMessage(Res);
+    return Thrown.empty() ? Err : Err + " (" + Thrown + ")";
+  }
+  if (!Thrown.empty()) {
+    return std::string(FuncName) + ": " + Thrown;
+  }
+  return {};
+}
+
+std::string Instance::init(const InstanceConfig &Config) {
+  GasLimit = Config.GasLimit;
+  Configure = WasmEdge_ConfigureCreate();
+  addProposals(Configure, Config.Threads);
+  if (Config.Wasi) {
+    WasmEdge_ConfigureAddHostRegistration(Configure,
+                                          WasmEdge_HostRegistration_Wasi);
+  }
+  if (Config.Process) {
+    WasmEdge_ConfigureAddHostRegistration(
+        Configure, WasmEdge_HostRegistration_WasmEdge_Process);
+  }
+  Store = WasmEdge_StoreCreate();
+  VM = WasmEdge_VMCreate(Configure, Store);
+  Stat = WasmEdge_VMGetStatisticsContext(VM);
+  if (!Config.CostTable.empty()) {
+    CostTable = Config.CostTable;
+    WasmEdge_StatisticsSetCostTable(Stat, CostTable.data(), CostTable.size());
+  }
+
+  if (Config.HostMods != nullptr &&
+      !Config.HostMods->registerTo(VM, HostImports)) {
+    return "failed to register the host functions";
+  }
+  HostMods = Config.HostMods;
+  if (auto Err = registerDependencies(VM, Config.Dependencies); !Err.empty()) {
+    return Err;
+  }
+  if (WasmEdge_ImportObjectContext *ProcObject =
+          WasmEdge_VMGetImportModuleContext(
+              VM, WasmEdge_HostRegistration_WasmEdge_Process)) {
+    std::vector<const char *> AllowCmds;
+    for (auto &Cmd : Config.AllowedCmds) {
+      AllowCmds.push_back(Cmd.c_str());
+    }
+    WasmEdge_ImportObjectInitWasmEdgeProcess(ProcObject, AllowCmds.data(),
+                                             AllowCmds.size(),
+                                             Config.AllowedCmdsAll);
+  }
+  if (WasmEdge_ImportObjectContext *WasiMod = WasmEdge_VMGetImportModuleContext(
+          VM, WasmEdge_HostRegistration_Wasi)) {
+    std::vector<const char *> Args, Envs, Dirs;
+    for (auto &Arg : Config.WasiArgs) {
+      Args.push_back(Arg.c_str());
+    }
+    for (auto &Env : Config.WasiEnvs) {
+      Envs.push_back(Env.c_str());
+    }
+    for (auto &Dir : Config.WasiDirs) {
+      Dirs.push_back(Dir.c_str());
+    }
+    WasmEdge_ImportObjectInitWASI(WasiMod, Args.data(), Args.size(),
+                                  Envs.data(), Envs.size(), Dirs.data(),
+                                  Dirs.size(), nullptr, 0);
+  }
+
+  /// The module has been parsed and validated once on the JS thread
+  WasmEdge_Result Res = WasmEdge_VMLoadWasmFromASTModule(VM, Config.AST.get());
+  if (WasmEdge_ResultOK(Res)) {
+    Res = WasmEdge_VMValidate(VM);
+  }
+  if (WasmEdge_ResultOK(Res)) {
+    Res = WasmEdge_VMInstantiate(VM);
+  }
+  if (!WasmEdge_ResultOK(Res)) {
+    return WasmEdge_ResultGetMessage(Res);
+  }
+
+  uint32_t MemLen = WasmEdge_StoreListMemoryLength(Store);
+  if (MemLen == 0) {
+    return "the module has no memory";
+  }
+  std::vector<WasmEdge_String> MemNames(MemLen);
+  WasmEdge_StoreListMemory(Store, MemNames.data(), MemLen);
+  MemInst = WasmEdge_StoreFindMemory(Store, MemNames[0]);
+  adviseLinearMemory(MemInst, Config.HugePages, Config.PrefaultMemory);
+
+  /// WASI reactors must be initialized before their exports are called
+  WasmEdge_String InitFunc = WasmEdge_StringCreateByCString("_initialize");
+  const WasmEdge_FunctionTypeContext *InitType =
+      WasmEdge_VMGetFunctionType(VM, InitFunc);
+  WasmEdge_StringDelete(InitFunc);
+  if (InitType != nullptr) {
+    return execute("_initialize", nullptr, 0, nullptr, 0);
+  }
+  return {};
+}
+
+void Instance::setGasLimit(uint64_t Limit) {
+  GasLimit = Limit;
+  if (Stat && GasLimit == 0) {
+    WasmEdge_StatisticsSetCostLimit(Stat, UINT64_MAX);
+  }
+}
+
+std::string Instance::callBytes(const std::string &FuncName,
+                                const uint8_t *Data, uint32_t Size,
+                                std::vector<uint8_t> &Result) {
+  /// The statistics of the instance add up, so every call gets the budget
+  /// on top of what has been spent so far
+  if (GasLimit > 0) {
+    WasmEdge_StatisticsSetCostLimit(
+        Stat, WasmEdge_StatisticsGetTotalCost(Stat) + GasLimit);
+  }
+  WasmEdge_String Name = WasmEdge_StringCreateByCString(FuncName.c_str());
+  bool MultiValue = returnsPtrLen(WasmEdge_VMGetFunctionType(VM, Name));
+  WasmEdge_StringDelete(Name);
+
+  WasmEdge_Value Params[3];
+  WasmEdge_Value Rets[2];
+  Params[0] = WasmEdge_ValueGenI32(Size);
+  if (auto Err = execute("__wbindgen_malloc", Params, 1, Rets, 1);
+      !Err.empty()) {
+    return Err;
+  }
+  uint32_t Addr = static_cast<uint32_t>(WasmEdge_ValueGetI32(Rets[0]));
+  WasmEdge_Result Res = WasmEdge_MemoryInstanceSetData(
+      MemInst, const_cast<uint8_t *>(Data), Addr, Size);
+  if (!WasmEdge_ResultOK(Res)) {
+    return WasmEdge_ResultGetMessage(Res);
+  }
+
+  /// Same conventions as the Run* methods, see GetResultPtrLen()
+  const uint32_t ResultMemAddr = 8;
+  uint32_t ParamLen = 0;
+  if (!MultiValue) {
+    Params[ParamLen++] = WasmEdge_ValueGenI32(ResultMemAddr);
+  }
+  Params[ParamLen++] = WasmEdge_ValueGenI32(Addr);
+  Params[ParamLen++] = WasmEdge_ValueGenI32(Size);
+  if (auto Err = execute(FuncName.c_str(), Params, ParamLen, Rets,
+                         MultiValue ? 2 : 1);
+      !Err.empty()) {
+    return Err;
+  }
+
+  uint32_t ResultAddr, ResultLen;
+  if (MultiValue) {
+    ResultAddr = static_cast<uint32_t>(WasmEdge_ValueGetI32(Rets[0]));
+    ResultLen = static_cast<uint32_t>(WasmEdge_ValueGetI32(Rets[1]));
+  } else {
+    uint8_t ResultMem[8];
+    Res = WasmEdge_MemoryInstanceGetData(MemInst, ResultMem, ResultMemAddr, 8);
+    if (!WasmEdge_ResultOK(Res)) {
+      return WasmEdge_ResultGetMessage(Res);
+    }
+    auto U32 = [&ResultMem](int I) {
+      return static_cast<uint32_t>(ResultMem[I]) |
+             (static_cast<uint32_t>(ResultMem[I + 1]) << 8) |
+             (static_cast<uint32_t>(ResultMem[I + 2]) << 16) |
+             (static_cast<uint32_t>(ResultMem[I + 3]) << 24);
+    };
+    ResultAddr = U32(0);
+    ResultLen = U32(4);
+  }
+
+  Result.resize(ResultLen);
+  Res = WasmEdge_MemoryInstanceGetData(MemInst, Result.data(), ResultAddr,
+                                       ResultLen);
+  if (!WasmEdge_ResultOK(Res)) {
+    return WasmEdge_ResultGetMessage(Res);
+  }
+  Params[0] = WasmEdge_ValueGenI32(ResultAddr);
+  Params[1] = WasmEdge_ValueGenI32(ResultLen);
+  return execute("__wbindgen_free", Params, 2, nullptr, 0);
+}
+
+} // namespace NAPI
+} // namespace WASMEDGE
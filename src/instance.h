@@ -0,0 +1,83 @@
+#pragma once
+
+#include "dependency.h"
+#include "hostfunction.h"
+#include "prefault.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <wasmedge.h>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+/// The compiler and every VM must agree on the enabled proposals
+void addProposals(WasmEdge_ConfigureContext *Conf, bool Threads);
+
+/// Export returning (ptr, len) in registers, which needs the multi-value
+/// proposal, instead of writing it through a return pointer argument.
+bool returnsPtrLen(const WasmEdge_FunctionTypeContext *Type);
+
+/// Settings of the instances created by RunParallel(). They are copied from
+/// the VM on the JS thread, so that the worker threads never touch Napi.
+struct InstanceConfig {
+  std::shared_ptr<WasmEdge_ASTModuleContext> AST;
+  bool Threads = false;
+  bool Wasi = true;
+  bool Process = true;
+  std::vector<std::string> WasiArgs, WasiEnvs, WasiDirs, AllowedCmds;
+  bool AllowedCmdsAll = false;
+  /// Gas budget of each call and cost table, see Options
+  uint64_t GasLimit = 0;
+  std::vector<uint64_t> CostTable;
+  /// Advice on the initial linear memory, see adviseLinearMemory()
+  bool HugePages = false;
+  bool PrefaultMemory = false;
+  /// JS host functions, called back through their thread-safe function
+  HostModules *HostMods = nullptr;
+  /// Modules registered before instantiating, see Options
+  std::vector<Dependency> Dependencies;
+};
+
+/// One instance of a wasm-bindgen module without any Napi dependency, so that
+/// it can live in a native worker thread.
+class Instance {
+private:
+  WasmEdge_ConfigureContext *Configure = nullptr;
+  WasmEdge_StoreContext *Store = nullptr;
+  WasmEdge_VMContext *VM = nullptr;
+  WasmEdge_MemoryInstanceContext *MemInst = nullptr;
+  WasmEdge_StatisticsContext *Stat = nullptr;
+  uint64_t GasLimit = 0;
+  std::vector<uint64_t> CostTable;
+  std::vector<WasmEdge_ImportObjectContext *> HostImports;
+  /// Exceptions of the host functions called from this thread fail the call
+  HostModules *HostMods = nullptr;
+
+  std::string execute(const char *FuncName, const WasmEdge_Value *Params,
+                      uint32_t ParamLen, WasmEdge_Value *Rets,
+                      uint32_t RetLen);
+
+public:
+  Instance() = default;
+  Instance(const Instance &) = delete;
+  Instance &operator=(const Instance &) = delete;
+  ~Instance();
+
+  /// Return an error message, empty on success
+  std::string init(const InstanceConfig &Config);
+  /// Call an export taking one byte buffer and returning one
+  std::string callBytes(const std::string &FuncName, const uint8_t *Data,
+                        uint32_t Size, std::vector<uint8_t> &Result);
+  /// Gas budget of the following calls, 0 for unlimited
+  void setGasLimit(uint64_t Limit);
+  /// Size of the linear memory, in 64 KiB pages
+  uint32_t getMemoryPages() const {
+    return MemInst ? WasmEdge_MemoryInstanceGetPageSize(MemInst) : 0;
+  }
+};
+
+} // namespace NAPI
+} // namespace WASMEDGE
@@ -0,0 +1,176 @@
+#include "memfs.h"
+#include "utils.h"
+
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+namespace {
+
+std::string makePrivateDir() {
+  std::string Template = std::filesystem::is_directory("/dev/shm")
+                             ? "/dev/shm/wasmedge.memfs.XXXXXX"
+                             : "/tmp/wasmedge.memfs.XXXXXX";
+  std::vector<char> Path(Template.begin(), Template.end());
+  Path.push_back('\0');
+  if (mkdtemp(Path.data()) == nullptr) {
+    return "";
+  }
+  return std::string(Path.data());
+}
+
+int openMemFile(const char *Name) {
+  int Fd = memfd_create(Name, MFD_CLOEXEC);
+  if (Fd < 0) {
+    // Fallback to an unlinked temporary file
+    FILE *File = tmpfile();
+    if (File != nullptr) {
+      Fd = dup(fileno(File));
+      fclose(File);
+    }
+  }
+  return Fd;
+}
+
+void readAll(int Fd, std::vector<uint8_t> &Data) {
+  Data.clear();
+  if (lseek(Fd, 0, SEEK_SET) < 0) {
+    return;
+  }
+  uint8_t Buf[65536];
+  ssize_t Len;
+  while ((Len = read(Fd, Buf, sizeof(Buf))) > 0) {
+    Data.insert(Data.end(), Buf, Buf + Len);
+  }
+}
+
+/// Held from begin() to end(). Recursive, a host function may start another
+/// capture on the same thread, which is nested in the first one.
+std::recursive_mutex CaptureMutex;
+
+} // namespace
+
+bool MemoryFS::mount(const std::map<std::string, MemFSFiles> &Dirs) {
+  unmount();
+  Root = makePrivateDir();
+  if (Root.empty()) {
+    return false;
+  }
+  size_t Idx = 0;
+  for (const auto &[GuestDir, Files] : Dirs) {
+    std::filesystem::path HostDir =
+        std::filesystem::path(Root) / std::to_string(Idx++);
+    std::error_code EC;
+    std::filesystem::create_directories(HostDir, EC);
+    if (EC) {
+      unmount();
+      return false;
+    }
+    for (const auto &[Name, Content] : Files) {
+      std::filesystem::path FilePath =
+          (HostDir / Name).lexically_normal();
+      // Keep the files inside the preopened directory
+      std::string Prefix = HostDir.string() + "/";
+      if (FilePath.string().compare(0, Prefix.size(), Prefix) != 0) {
+        unmount();
+        return false;
+      }
+      std::filesystem::create_directories(FilePath.parent_path(), EC);
+      std::ofstream File(FilePath, std::ios::binary);
+      File.write(reinterpret_cast<const char *>(Content.data()),
+                 Content.size());
+      if (EC || !File.good()) {
+        unmount();
+        return false;
+      }
+    }
+    GuestDirs.push_back(GuestDir);
+    Preopens.push_back(GuestDir + ":" + HostDir.string());
+  }
+  return true;
+}
+
+void MemoryFS::collect(std::map<std::string, MemFSFiles> &Dirs) const {
+  Dirs.clear();
+  for (size_t Idx = 0; Idx < GuestDirs.size(); Idx++) {
+    std::filesystem::path HostDir =
+        std::filesystem::path(Root) / std::to_string(Idx);
+    MemFSFiles &Files = Dirs[GuestDirs[Idx]];
+    std::error_code EC;
+    for (auto It = std::filesystem::recursive_directory_iterator(HostDir, EC);
+         !EC && It != std::filesystem::recursive_directory_iterator();
+         It.increment(EC)) {
+      if (!It->is_regular_file()) {
+        continue;
+      }
+      std::ifstream File(It->path(), std::ios::binary);
+      Files[std::filesystem::relative(It->path(), HostDir).string()] =
+          std::vector<uint8_t>((std::istreambuf_iterator<char>(File)),
+                               std::istreambuf_iterator<char>());
+    }
+  }
+}
+
+void MemoryFS::unmount() {
+  if (!Root.empty()) {
+    std::error_code EC;
+    std::filesystem::remove_all(Root, EC);
+    Root.clear();
+  }
+  Preopens.clear();
+  GuestDirs.clear();
+}
+
+StdioCapture::~StdioCapture() {
+  std::vector<uint8_t> Ignored[2];
+  end(Ignored[0], Ignored[1]);
+}
+
+bool StdioCapture::begin() {
+  const char *Names[2] = {"wasmedge.stdout", "wasmedge.stderr"};
+  Lock = std::unique_lock<std::recursive_mutex>(CaptureMutex);
+  fflush(stdout);
+  fflush(stderr);
+  for (int I = 0; I < 2; I++) {
+    int TargetFd = I + 1;
+    MemFds[I] = openMemFile(Names[I]);
+    SavedFds[I] = dup(TargetFd);
+    if (MemFds[I] < 0 || SavedFds[I] < 0 || dup2(MemFds[I], TargetFd) < 0) {
+      std::vector<uint8_t> Ignored[2];
+      end(Ignored[0], Ignored[1]);
+      return false;
+    }
+  }
+  return true;
+}
+
+void StdioCapture::end(std::vector<uint8_t> &Stdout,
+                       std::vector<uint8_t> &Stderr) {
+  std::vector<uint8_t> *Outputs[2] = {&Stdout, &Stderr};
+  fflush(stdout);
+  fflush(stderr);
+  for (int I = 0; I < 2; I++) {
+    if (SavedFds[I] >= 0) {
+      dup2(SavedFds[I], I + 1);
+      close(SavedFds[I]);
+      SavedFds[I] = -1;
+    }
+    if (MemFds[I] >= 0) {
+      readAll(MemFds[I], *Outputs[I]);
+      close(MemFds[I]);
+      MemFds[I] = -1;
+    }
+  }
+  if (Lock.owns_lock()) {
+    Lock.unlock();
+  }
+}
+
+} // namespace NAPI
+} // namespace WASMEDGE
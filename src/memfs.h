@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+/// Files of one preopened directory: <relative_path> -> <content>
+using MemFSFiles = std::map<std::string, std::vector<uint8_t>>;
+
+/// Backs WASI preopens with files given from JS.
+///
+/// WASI can only preopen host directories, so the files are materialized in a
+/// private directory on a memory-backed filesystem (/dev/shm when available)
+/// for the duration of one execution.
+class MemoryFS {
+private:
+  std::string Root;
+  std::vector<std::string> Preopens;
+  std::vector<std::string> GuestDirs;
+
+public:
+  ~MemoryFS() { unmount(); }
+
+  bool mount(const std::map<std::string, MemFSFiles> &Dirs);
+  /// Read back every file, including the ones created by the guest
+  void collect(std::map<std::string, MemFSFiles> &Dirs) const;
+  void unmount();
+  bool isMounted() const noexcept { return !Root.empty(); }
+  /// Dir format: <guest_path>:<host_path>
+  const std::vector<std::string> &getPreopens() const noexcept {
+    return Preopens;
+  }
+};
+
+/// Redirects stdout and stderr of the process into memory files while the
+/// wasm application runs.
+///
+/// WASI offers no way to give the guest other descriptors for its stdio, so
+/// fds 1 and 2 of the whole process are redirected: output of the other
+/// threads, e.g. worker_threads or RunAsync() threads, is captured as well.
+/// Captures are serialized process-wide, so that each one restores the fds
+/// saved by itself.
+class StdioCapture {
+private:
+  std::unique_lock<std::recursive_mutex> Lock;
+  int SavedFds[2] = {-1, -1};
+  int MemFds[2] = {-1, -1};
+
+public:
+  ~StdioCapture();
+
+  bool begin();
+  void end(std::vector<uint8_t> &Stdout, std::vector<uint8_t> &Stderr);
+};
+
+} // namespace NAPI
+} // namespace WASMEDGE
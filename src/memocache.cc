@@ -0,0 +1,54 @@
+#include "memocache.h"
+
+namespace WASMEDGE {
+namespace NAPI {
+
+void MemoCache::setMaxBytes(uint64_t Max) {
+  MaxBytes = Max;
+  evict();
+}
+
+const std::vector<uint8_t> *MemoCache::find(const std::string &Key) {
+  auto It = Index.find(Key);
+  if (It == Index.end()) {
+    ++Misses;
+    return nullptr;
+  }
+  ++Hits;
+  Entries.splice(Entries.begin(), Entries, It->second);
+  return &It->second->Value;
+}
+
+void MemoCache::insert(std::string Key, std::vector<uint8_t> Value) {
+  if (auto It = Index.find(Key); It != Index.end()) {
+    Bytes -= sizeOf(*It->second);
+    Entries.erase(It->second);
+    Index.erase(It);
+  }
+  Entry E{std::move(Key), std::move(Value)};
+  if (sizeOf(E) > MaxBytes) {
+    return;
+  }
+  Bytes += sizeOf(E);
+  Entries.push_front(std::move(E));
+  Index.emplace(Entries.front().Key, Entries.begin());
+  evict();
+}
+
+void MemoCache::evict() {
+  while (Bytes > MaxBytes && !Entries.empty()) {
+    Bytes -= sizeOf(Entries.back());
+    Index.erase(Entries.back().Key);
+    Entries.pop_back();
+    ++Evictions;
+  }
+}
+
+void MemoCache::clear() {
+  Index.clear();
+  Entries.clear();
+  Bytes = 0;
+}
+
+} // namespace NAPI
+} // namespace WASMEDGE
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+/// Results of pure exports keyed by function name and marshalled arguments.
+///
+/// The full key is kept so that a hash collision can never return the result
+/// of another input. Least recently used entries are evicted once the keys
+/// and results exceed the byte budget.
+class MemoCache {
+private:
+  struct Entry {
+    std::string Key;
+    std::vector<uint8_t> Value;
+  };
+  std::list<Entry> Entries;
+  std::unordered_map<std::string_view, std::list<Entry>::iterator> Index;
+  uint64_t MaxBytes = 0;
+  uint64_t Bytes = 0;
+  uint64_t Hits = 0;
+  uint64_t Misses = 0;
+  uint64_t Evictions = 0;
+
+  static uint64_t sizeOf(const Entry &E) noexcept {
+    /// Approximation of the list node and the index slot
+    return E.Key.size() + E.Value.size() + 64;
+  }
+  void evict();
+
+public:
+  void setMaxBytes(uint64_t Max);
+  /// Return nullptr on a miss. The pointer is valid until the next insert.
+  const std::vector<uint8_t> *find(const std::string &Key);
+  void insert(std::string Key, std::vector<uint8_t> Value);
+  void clear();
+
+  uint64_t getHits() const noexcept { return Hits; }
+  uint64_t getMisses() const noexcept { return Misses; }
+  uint64_t getEvictions() const noexcept { return Evictions; }
+  uint64_t getBytes() const noexcept { return Bytes; }
+  uint64_t getEntries() const noexcept { return Entries.size(); }
+};
+
+} // namespace NAPI
+} // namespace WASMEDGE
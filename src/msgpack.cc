@@ -0,0 +1,387 @@
+#include "msgpack.h"
+
+#include <cmath>
+#include <cstring>
+#include <string>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+namespace {
+/// Same nesting limit for both directions, deep enough for real data
+constexpr uint32_t kMaxDepth = 256;
+constexpr double kMaxSafeInteger = 9007199254740991.0;
+
+template <typename T> void putBE(std::vector<uint8_t> &Out, T Value) {
+  for (int Shift = (sizeof(T) - 1) * 8; Shift >= 0; Shift -= 8) {
+    Out.push_back(static_cast<uint8_t>(static_cast<uint64_t>(Value) >> Shift));
+  }
+}
+
+void putUInt(std::vector<uint8_t> &Out, uint64_t V) {
+  if (V < 0x80) {
+    Out.push_back(static_cast<uint8_t>(V));
+  } else if (V <= 0xff) {
+    Out.push_back(0xcc);
+    putBE<uint8_t>(Out, V);
+  } else if (V <= 0xffff) {
+    Out.push_back(0xcd);
+    putBE<uint16_t>(Out, V);
+  } else if (V <= 0xffffffff) {
+    Out.push_back(0xce);
+    putBE<uint32_t>(Out, V);
+  } else {
+    Out.push_back(0xcf);
+    putBE<uint64_t>(Out, V);
+  }
+}
+
+void putInt(std::vector<uint8_t> &Out, int64_t V) {
+  if (V >= 0) {
+    putUInt(Out, static_cast<uint64_t>(V));
+  } else if (V >= -32) {
+    Out.push_back(static_cast<uint8_t>(V));
+  } else if (V >= INT8_MIN) {
+    Out.push_back(0xd0);
+    putBE<uint8_t>(Out, V);
+  } else if (V >= INT16_MIN) {
+    Out.push_back(0xd1);
+    putBE<uint16_t>(Out, V);
+  } else if (V >= INT32_MIN) {
+    Out.push_back(0xd2);
+    putBE<uint32_t>(Out, V);
+  } else {
+    Out.push_back(0xd3);
+    putBE<uint64_t>(Out, V);
+  }
+}
+
+void putDouble(std::vector<uint8_t> &Out, double D) {
+  uint64_t Bits;
+  std::memcpy(&Bits, &D, sizeof(Bits));
+  Out.push_back(0xcb);
+  putBE<uint64_t>(Out, Bits);
+}
+
+/// Header of str, bin, array and map, FixBase/FixLimit describe the fix form
+void putHeader(std::vector<uint8_t> &Out, size_t Size, uint8_t FixBase,
+               size_t FixLimit, uint8_t Op8, uint8_t Op16, uint8_t Op32) {
+  if (Size < FixLimit) {
+    Out.push_back(static_cast<uint8_t>(FixBase | Size));
+  } else if (Op8 != 0 && Size <= 0xff) {
+    Out.push_back(Op8);
+    putBE<uint8_t>(Out, Size);
+  } else if (Size <= 0xffff) {
+    Out.push_back(Op16);
+    putBE<uint16_t>(Out, Size);
+  } else {
+    Out.push_back(Op32);
+    putBE<uint32_t>(Out, Size);
+  }
+}
+
+void putBytes(std::vector<uint8_t> &Out, uint8_t Op8, uint8_t Op16,
+              uint8_t Op32, const uint8_t *Data, size_t Size) {
+  putHeader(Out, Size, Op8, 0, Op8, Op16, Op32);
+  Out.insert(Out.end(), Data, Data + Size);
+}
+
+void putString(std::vector<uint8_t> &Out, const std::string &S) {
+  putHeader(Out, S.size(), 0xa0, 32, 0xd9, 0xda, 0xdb);
+  Out.insert(Out.end(), S.begin(), S.end());
+}
+
+bool encode(Napi::Env Env, const Napi::Value &Value,
+            std::vector<uint8_t> &Out, uint32_t Depth) {
+  /// A throwing getter or proxy trap leaves an empty value and an exception
+  if (Depth > kMaxDepth || Env.IsExceptionPending()) {
+    return false;
+  }
+  switch (Value.Type()) {
+  case napi_undefined:
+  case napi_null:
+    Out.push_back(0xc0);
+    return true;
+  case napi_boolean:
+    Out.push_back(Value.As<Napi::Boolean>().Value() ? 0xc3 : 0xc2);
+    return true;
+  case napi_number: {
+    double D = Value.As<Napi::Number>().DoubleValue();
+    if (std::trunc(D) == D && std::fabs(D) <= kMaxSafeInteger) {
+      putInt(Out, static_cast<int64_t>(D));
+    } else {
+      putDouble(Out, D);
+    }
+    return true;
+  }
+  case napi_bigint: {
+    bool Lossless;
+    int64_t S = Value.As<Napi::BigInt>().Int64Value(&Lossless);
+    if (Lossless) {
+      putInt(Out, S);
+      return true;
+    }
+    uint64_t U = Value.As<Napi::BigInt>().Uint64Value(&Lossless);
+    if (Lossless) {
+      putUInt(Out, U);
+      return true;
+    }
+    return false;
+  }
+  case napi_string:
+    putString(Out, Value.As<Napi::String>().Utf8Value());
+    return true;
+  case napi_object:
+    break;
+  default:
+    return false;
+  }
+
+  if (Value.IsTypedArray()) {
+    Napi::TypedArray Array = Value.As<Napi::TypedArray>();
+    putBytes(Out, 0xc4, 0xc5, 0xc6,
+             static_cast<uint8_t *>(Array.ArrayBuffer().Data()) +
+                 Array.ByteOffset(),
+             Array.ByteLength());
+    return true;
+  }
+  if (Value.IsArrayBuffer()) {
+    Napi::ArrayBuffer Buffer = Value.As<Napi::ArrayBuffer>();
+    putBytes(Out, 0xc4, 0xc5, 0xc6, static_cast<uint8_t *>(Buffer.Data()),
+             Buffer.ByteLength());
+    return true;
+  }
+  if (Value.IsArray()) {
+    Napi::Array Array = Value.As<Napi::Array>();
+    uint32_t Length = Array.Length();
+    putHeader(Out, Length, 0x90, 16, 0, 0xdc, 0xdd);
+    for (uint32_t I = 0; I < Length; ++I) {
+      if (!encode(Env, Array.Get(I), Out, Depth + 1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  Napi::Object Object = Value.As<Napi::Object>();
+  Napi::Array Keys = Object.GetPropertyNames();
+  if (Env.IsExceptionPending()) {
+    return false;
+  }
+  uint32_t Length = Keys.Length();
+  putHeader(Out, Length, 0x80, 16, 0, 0xde, 0xdf);
+  for (uint32_t I = 0; I < Length; ++I) {
+    Napi::Value Key = Keys.Get(I);
+    putString(Out, Key.ToString().Utf8Value());
+    if (!encode(Env, Object.Get(Key), Out, Depth + 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+class Decoder {
+private:
+  Napi::Env Env;
+  const uint8_t *Cur;
+  const uint8_t *End;
+
+  bool need(size_t N) const noexcept {
+    return static_cast<size_t>(End - Cur) >= N;
+  }
+  template <typename T> bool getBE(T &Value) noexcept {
+    if (!need(sizeof(T))) {
+      return false;
+    }
+    uint64_t V = 0;
+    for (size_t I = 0; I < sizeof(T); ++I) {
+      V = (V << 8) | *Cur++;
+    }
+    Value = static_cast<T>(V);
+    return true;
+  }
+  Napi::Value makeInt(int64_t V) {
+    if (std::fabs(static_cast<double>(V)) <= kMaxSafeInteger) {
+      return Napi::Number::New(Env, static_cast<double>(V));
+    }
+    return Napi::BigInt::New(Env, V);
+  }
+  Napi::Value makeUInt(uint64_t V) {
+    if (static_cast<double>(V) <= kMaxSafeInteger) {
+      return Napi::Number::New(Env, static_cast<double>(V));
+    }
+    return Napi::BigInt::New(Env, V);
+  }
+  Napi::Value makeString(uint32_t Size) {
+    if (!need(Size)) {
+      return Napi::Value();
+    }
+    const char *Data = reinterpret_cast<const char *>(Cur);
+    Cur += Size;
+    return Napi::String::New(Env, Data, Size);
+  }
+  Napi::Value makeBin(uint32_t Size) {
+    if (!need(Size)) {
+      return Napi::Value();
+    }
+    Napi::ArrayBuffer Buffer = Napi::ArrayBuffer::New(Env, Size);
+    std::memcpy(Buffer.Data(), Cur, Size);
+    Cur += Size;
+    return Napi::Uint8Array::New(Env, Size, Buffer, 0, napi_uint8_array);
+  }
+  Napi::Value makeArray(uint32_t Size, uint32_t Depth) {
+    /// Every element takes at least one byte, do not trust the header
+    if (!need(Size)) {
+      return Napi::Value();
+    }
+    Napi::Array Array = Napi::Array::New(Env, Size);
+    for (uint32_t I = 0; I < Size; ++I) {
+      Napi::Value Element = decode(Depth + 1);
+      if (Element.IsEmpty()) {
+        return Napi::Value();
+      }
+      Array.Set(I, Element);
+    }
+    return Array;
+  }
+  Napi::Value makeMap(uint32_t Size, uint32_t Depth) {
+    if (!need(static_cast<size_t>(Size) * 2)) {
+      return Napi::Value();
+    }
+    Napi::Object Object = Napi::Object::New(Env);
+    for (uint32_t I = 0; I < Size; ++I) {
+      Napi::Value Key = decode(Depth + 1);
+      if (Key.IsEmpty() || (!Key.IsString() && !Key.IsNumber())) {
+        return Napi::Value();
+      }
+      Napi::Value Element = decode(Depth + 1);
+      if (Element.IsEmpty()) {
+        return Napi::Value();
+      }
+      /// Define own properties like JSON.parse, so that a "__proto__" key
+      /// does not replace the prototype.
+      napi_property_descriptor Desc = {
+          nullptr, Key.ToString(), nullptr, nullptr, nullptr, Element,
+          static_cast<napi_property_attributes>(
+              napi_writable | napi_enumerable | napi_configurable),
+          nullptr};
+      if (napi_define_properties(Env, Object, 1, &Desc) != napi_ok) {
+        return Napi::Value();
+      }
+    }
+    return Object;
+  }
+
+public:
+  Decoder(Napi::Env Env, const uint8_t *Data, size_t Size)
+      : Env(Env), Cur(Data), End(Data + Size) {}
+
+  bool done() const noexcept { return Cur == End; }
+
+  Napi::Value decode(uint32_t Depth) {
+    uint8_t Op;
+    if (Depth > kMaxDepth || !getBE(Op)) {
+      return Napi::Value();
+    }
+    if (Op < 0x80) {
+      return Napi::Number::New(Env, Op);
+    }
+    if (Op >= 0xe0) {
+      return Napi::Number::New(Env, static_cast<int8_t>(Op));
+    }
+    if ((Op & 0xf0) == 0x80) {
+      return makeMap(Op & 0x0f, Depth);
+    }
+    if ((Op & 0xf0) == 0x90) {
+      return makeArray(Op & 0x0f, Depth);
+    }
+    if ((Op & 0xe0) == 0xa0) {
+      return makeString(Op & 0x1f);
+    }
+
+    uint8_t U8;
+    uint16_t U16;
+    uint32_t U32;
+    uint64_t U64;
+    switch (Op) {
+    case 0xc0:
+      return Env.Null();
+    case 0xc2:
+      return Napi::Boolean::New(Env, false);
+    case 0xc3:
+      return Napi::Boolean::New(Env, true);
+    case 0xc4:
+      return getBE(U8) ? makeBin(U8) : Napi::Value();
+    case 0xc5:
+      return getBE(U16) ? makeBin(U16) : Napi::Value();
+    case 0xc6:
+      return getBE(U32) ? makeBin(U32) : Napi::Value();
+    case 0xca: {
+      float F;
+      if (!getBE(U32)) {
+        return Napi::Value();
+      }
+      std::memcpy(&F, &U32, sizeof(F));
+      return Napi::Number::New(Env, F);
+    }
+    case 0xcb: {
+      double D;
+      if (!getBE(U64)) {
+        return Napi::Value();
+      }
+      std::memcpy(&D, &U64, sizeof(D));
+      return Napi::Number::New(Env, D);
+    }
+    case 0xcc:
+      return getBE(U8) ? makeUInt(U8) : Napi::Value();
+    case 0xcd:
+      return getBE(U16) ? makeUInt(U16) : Napi::Value();
+    case 0xce:
+      return getBE(U32) ? makeUInt(U32) : Napi::Value();
+    case 0xcf:
+      return getBE(U64) ? makeUInt(U64) : Napi::Value();
+    case 0xd0:
+      return getBE(U8) ? makeInt(static_cast<int8_t>(U8)) : Napi::Value();
+    case 0xd1:
+      return getBE(U16) ? makeInt(static_cast<int16_t>(U16)) : Napi::Value();
+    case 0xd2:
+      return getBE(U32) ? makeInt(static_cast<int32_t>(U32)) : Napi::Value();
+    case 0xd3:
+      return getBE(U64) ? makeInt(static_cast<int64_t>(U64)) : Napi::Value();
+    case 0xd9:
+      return getBE(U8) ? makeString(U8) : Napi::Value();
+    case 0xda:
+      return getBE(U16) ? makeString(U16) : Napi::Value();
+    case 0xdb:
+      return getBE(U32) ? makeString(U32) : Napi::Value();
+    case 0xdc:
+      return getBE(U16) ? makeArray(U16, Depth) : Napi::Value();
+    case 0xdd:
+      return getBE(U32) ? makeArray(U32, Depth) : Napi::Value();
+    case 0xde:
+      return getBE(U16) ? makeMap(U16, Depth) : Napi::Value();
+    case 0xdf:
+      return getBE(U32) ? makeMap(U32, Depth) : Napi::Value();
+    default:
+      // Extension types and the reserved 0xc1
+      return Napi::Value();
+    }
+  }
+};
+} // namespace
+
+bool encodeMsgPack(const Napi::Value &Value, std::vector<uint8_t> &Out) {
+  return encode(Value.Env(), Value, Out, 0);
+}
+
+Napi::Value decodeMsgPack(Napi::Env Env, const uint8_t *Data, size_t Size) {
+  Decoder Dec(Env, Data, Size);
+  Napi::Value Value = Dec.decode(0);
+  if (Value.IsEmpty() || !Dec.done()) {
+    return Napi::Value();
+  }
+  return Value;
+}
+
+} // namespace NAPI
+} // namespace WASMEDGE
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <napi.h>
+#include <vector>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+/// Encode a JS value as MessagePack and append it to Out.
+///
+/// null and undefined become nil, numbers become integers when they are
+/// integral and safe, BigInts become 64-bit integers, typed arrays and
+/// ArrayBuffers become bin and other objects become maps of their enumerable
+/// properties. Return false for values without a representation (functions,
+/// symbols, too deeply nested data), or when reading a property threw; the
+/// JS exception is then left pending.
+bool encodeMsgPack(const Napi::Value &Value, std::vector<uint8_t> &Out);
+
+/// Decode exactly one MessagePack value covering the whole buffer. Integers
+/// outside the safe range become BigInts and bin becomes an Uint8Array.
+/// Return an empty value on malformed input or extension types.
+Napi::Value decodeMsgPack(Napi::Env Env, const uint8_t *Data, size_t Size);
+
+} // namespace NAPI
+} // namespace WASMEDGE
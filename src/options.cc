@@ -3,6 +3,35 @@
 namespace WASMEDGE {
 namespace NAPI {
 
+bool parseTenantPolicy(TenantPolicy &Policy, const Napi::Value &Value) {
+  if (!Value.IsObject()) {
+    return false;
+  }
+  Napi::Object Object = Value.As<Napi::Object>();
+  if (Object.Has(kTenantWeightString)) {
+    if (!Object.Get(kTenantWeightString).IsNumber()) {
+      return false;
+    }
+    Policy.Weight =
+        Object.Get(kTenantWeightString).As<Napi::Number>().DoubleValue();
+    if (!(Policy.Weight > 0)) {
+      return false;
+    }
+  }
+  if (Object.Has(kTenantMaxConcurrencyString)) {
+    if (!Object.Get(kTenantMaxConcurrencyString).IsNumber() ||
+        Object.Get(kTenantMaxConcurrencyString)
+                .As<Napi::Number>()
+                .Int64Value() < 0) {
+      return false;
+    }
+    Policy.MaxConcurrency = Object.Get(kTenantMaxConcurrencyString)
+                                .As<Napi::Number>()
+                                .Uint32Value();
+  }
+  return true;
+}
+
 namespace {
 
 bool parseWasiStartFlag(const Napi::Object &Options) {
@@ -118,6 +147,308 @@ bool parseEnvs(std::vector<std::string> &Envs, const Napi::Object &Options) {
   return true;
 }
 
+bool parseMemFS(std::map<std::string, MemFSFiles> &MemFS,
+                const Napi::Object &Options) {
+  MemFS.clear();
+  if (Options.Has(kMemFSString) && Options.Get(kMemFSString).IsObject()) {
+    // Format: { <guest_path>: { <relative_file_path>: <content> } }
+    Napi::Object Dirs = Options.Get(kMemFSString).As<Napi::Object>();
+    Napi::Array DirKeys = Dirs.GetPropertyNames();
+    for (uint32_t i = 0; i < DirKeys.Length(); i++) {
+      Napi::Value DirKey = DirKeys[i];
+      Napi::Value Dir = Dirs.Get(DirKey);
+      if (!DirKey.IsString() || !Dir.IsObject()) {
+        return false;
+      }
+      MemFSFiles &Files = MemFS[DirKey.As<Napi::String>().Utf8Value()];
+      Napi::Array FileKeys = Dir.As<Napi::Object>().GetPropertyNames();
+      for (uint32_t j = 0; j < FileKeys.Length(); j++) {
+        Napi::Value FileKey = FileKeys[j];
+        Napi::Value Content = Dir.As<Napi::Object>().Get(FileKey);
+        if (!FileKey.IsString()) {
+          return false;
+        }
+        std::vector<uint8_t> &Data =
+            Files[FileKey.As<Napi::String>().Utf8Value()];
+        if (Content.IsString()) {
+          std::string Str = Content.As<Napi::String>().Utf8Value();
+          Data.assign(Str.begin(), Str.end());
+        } else if (Content.IsTypedArray() &&
+                   Content.As<Napi::TypedArray>().TypedArrayType() ==
+                       napi_uint8_array) {
+          Napi::TypedArray Array = Content.As<Napi::TypedArray>();
+          uint8_t *Begin = static_cast<uint8_t *>(Array.ArrayBuffer().Data()) +
+                           Array.ByteOffset();
+          Data.assign(Begin, Begin + Array.ByteLength());
+        } else {
+          // content must be a string or an Uint8Array
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool parseDependencies(std::map<std::string, DependencySource> &Dependencies,
+                       const Napi::Object &Options) {
+  Dependencies.clear();
+  if (!Options.Has(kDependenciesString)) {
+    return true;
+  }
+  if (!Options.Get(kDependenciesString).IsObject()) {
+    return false;
+  }
+  // Format: { <module_name>: <wasm_path> | <wasm_bytes> }
+  Napi::Object Deps = Options.Get(kDependenciesString).As<Napi::Object>();
+  Napi::Array Keys = Deps.GetPropertyNames();
+  for (uint32_t i = 0; i < Keys.Length(); i++) {
+    Napi::Value Key = Keys[i];
+    Napi::Value Source = Deps.Get(Key);
+    if (!Key.IsString() || Key.As<Napi::String>().Utf8Value().empty()) {
+      return false;
+    }
+    DependencySource &Dep = Dependencies[Key.As<Napi::String>().Utf8Value()];
+    if (Source.IsString()) {
+      Dep.Path = Source.As<Napi::String>().Utf8Value();
+    } else if (Source.IsTypedArray() &&
+               Source.As<Napi::TypedArray>().TypedArrayType() ==
+                   napi_uint8_array) {
+      Napi::TypedArray Array = Source.As<Napi::TypedArray>();
+      uint8_t *Begin = static_cast<uint8_t *>(Array.ArrayBuffer().Data()) +
+                       Array.ByteOffset();
+      Dep.Data.assign(Begin, Begin + Array.ByteLength());
+    } else {
+      // module must be a path or an Uint8Array
+      return false;
+    }
+  }
+  return true;
+}
+
+bool parseCaptureOutput(const Napi::Object &Options) {
+  if (Options.Has(kCaptureOutputString) &&
+      Options.Get(kCaptureOutputString).IsBoolean()) {
+    return Options.Get(kCaptureOutputString).As<Napi::Boolean>().Value();
+  }
+  return false;
+}
+
+bool parseAOTOptLevel(std::string &Level, const Napi::Object &Options) {
+  Level.clear();
+  if (Options.Has(kAOTOptimizationLevelString)) {
+    if (!Options.Get(kAOTOptimizationLevelString).IsString()) {
+      return false;
+    }
+    Level = Options.Get(kAOTOptimizationLevelString)
+                .As<Napi::String>()
+                .Utf8Value();
+    if (Level != "O0" && Level != "O1" && Level != "O2" && Level != "O3" &&
+        Level != "Os" && Level != "Oz") {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool parseAOTGenericBinary(const Napi::Object &Options) {
+  if (Options.Has(kAOTGenericBinaryString) &&
+      Options.Get(kAOTGenericBinaryString).IsBoolean()) {
+    return Options.Get(kAOTGenericBinaryString).As<Napi::Boolean>().Value();
+  }
+  return false;
+}
+
+bool parseAOTDumpCompileTime(const Napi::Object &Options) {
+  if (Options.Has(kAOTDumpCompileTimeString) &&
+      Options.Get(kAOTDumpCompileTimeString).IsBoolean()) {
+    return Options.Get(kAOTDumpCompileTimeString).As<Napi::Boolean>().Value();
+  }
+  return false;
+}
+
+bool parseAOTCompileTimeout(uint32_t &Timeout, const Napi::Object &Options) {
+  if (Options.Has(kAOTCompileTimeoutString)) {
+    if (!Options.Get(kAOTCompileTimeoutString).IsNumber()) {
+      return false;
+    }
+    Timeout =
+        Options.Get(kAOTCompileTimeoutString).As<Napi::Number>().Uint32Value();
+  }
+  return true;
+}
+
+bool parseMemoize(std::set<std::string> &Funcs, uint64_t &MaxBytes,
+                  const Napi::Object &Options) {
+  Funcs.clear();
+  if (Options.Has(kMemoizeString)) {
+    if (!Options.Get(kMemoizeString).IsArray()) {
+      return false;
+    }
+    Napi::Array Names = Options.Get(kMemoizeString).As<Napi::Array>();
+    for (uint32_t I = 0; I < Names.Length(); I++) {
+      Napi::Value Name = Names[I];
+      if (!Name.IsString()) {
+        return false;
+      }
+      Funcs.insert(Name.As<Napi::String>().Utf8Value());
+    }
+  }
+  if (Options.Has(kMemoizeMaxBytesString)) {
+    if (!Options.Get(kMemoizeMaxBytesString).IsNumber()) {
+      return false;
+    }
+    int64_t Max =
+        Options.Get(kMemoizeMaxBytesString).As<Napi::Number>().Int64Value();
+    if (Max < 0) {
+      return false;
+    }
+    MaxBytes = static_cast<uint64_t>(Max);
+  }
+  return true;
+}
+
+bool parseSessions(uint32_t &MaxSessions, uint32_t &IdleTimeout,
+                   const Napi::Object &Options) {
+  if (Options.Has(kMaxSessionsString)) {
+    if (!Options.Get(kMaxSessionsString).IsNumber() ||
+        Options.Get(kMaxSessionsString).As<Napi::Number>().Int64Value() < 1) {
+      return false;
+    }
+    MaxSessions =
+        Options.Get(kMaxSessionsString).As<Napi::Number>().Uint32Value();
+  }
+  if (Options.Has(kSessionIdleTimeoutString)) {
+    if (!Options.Get(kSessionIdleTimeoutString).IsNumber()) {
+      return false;
+    }
+    IdleTimeout = Options.Get(kSessionIdleTimeoutString)
+                      .As<Napi::Number>()
+                      .Uint32Value();
+  }
+  return true;
+}
+
+bool parseScheduler(PoolPolicy &Pool,
+                    std::map<std::string, TenantPolicy> &Tenants,
+                    const Napi::Object &Options) {
+  Tenants.clear();
+  for (const std::string *Key :
+       {&kSchedulerThreadsString, &kSchedulerMinThreadsString,
+        &kSchedulerTargetQueueTimeString, &kSchedulerIdleTimeoutString,
+        &kSchedulerMemoryBudgetString}) {
+    if (Options.Has(*Key) &&
+        (!Options.Get(*Key).IsNumber() ||
+         Options.Get(*Key).As<Napi::Number>().DoubleValue() < 0)) {
+      return false;
+    }
+  }
+  auto Get = [&Options](const std::string &Key) {
+    return Options.Get(Key).As<Napi::Number>();
+  };
+  if (Options.Has(kSchedulerThreadsString)) {
+    Pool.MaxThreads = Get(kSchedulerThreadsString).Uint32Value();
+  }
+  if (Options.Has(kSchedulerMinThreadsString)) {
+    Pool.MinThreads = Get(kSchedulerMinThreadsString).Uint32Value();
+  }
+  if (Options.Has(kSchedulerTargetQueueTimeString)) {
+    Pool.TargetQueueTime = Get(kSchedulerTargetQueueTimeString).DoubleValue();
+  }
+  if (Options.Has(kSchedulerIdleTimeoutString)) {
+    /// The idle threads wait this long for a call, 0 would make them spin
+    Pool.IdleTimeout = Get(kSchedulerIdleTimeoutString).Uint32Value();
+    if (Pool.IdleTimeout == 0) {
+      return false;
+    }
+  }
+  if (Options.Has(kSchedulerMemoryBudgetString)) {
+    Pool.MemoryBudget =
+        static_cast<uint64_t>(Get(kSchedulerMemoryBudgetString).Int64Value());
+  }
+  if (Options.Has(kTenantsString)) {
+    // Format: { <tenant>: { Weight, MaxConcurrency } }
+    if (!Options.Get(kTenantsString).IsObject()) {
+      return false;
+    }
+    Napi::Object Policies = Options.Get(kTenantsString).As<Napi::Object>();
+    Napi::Array Names = Policies.GetPropertyNames();
+    for (uint32_t I = 0; I < Names.Length(); I++) {
+      Napi::Value Name = Names[I];
+      if (!Name.IsString() ||
+          !parseTenantPolicy(Tenants[Name.As<Napi::String>().Utf8Value()],
+                             Policies.Get(Name))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool parseGasLimit(uint64_t &Limit, const Napi::Object &Options) {
+  if (Options.Has(kGasLimitString)) {
+    if (!Options.Get(kGasLimitString).IsNumber()) {
+      return false;
+    }
+    int64_t Value =
+        Options.Get(kGasLimitString).As<Napi::Number>().Int64Value();
+    if (Value < 0) {
+      return false;
+    }
+    Limit = static_cast<uint64_t>(Value);
+  }
+  return true;
+}
+
+bool parseRecord(std::string &Path, double &SampleRate,
+                 const Napi::Object &Options) {
+  if (Options.Has(kRecordString)) {
+    if (!Options.Get(kRecordString).IsString()) {
+      return false;
+    }
+    Path = Options.Get(kRecordString).As<Napi::String>().Utf8Value();
+  }
+  if (Options.Has(kRecordSampleRateString)) {
+    if (!Options.Get(kRecordSampleRateString).IsNumber()) {
+      return false;
+    }
+    SampleRate =
+        Options.Get(kRecordSampleRateString).As<Napi::Number>().DoubleValue();
+    if (!(SampleRate >= 0 && SampleRate <= 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool parseCostTable(std::vector<uint64_t> &Table,
+                    const Napi::Object &Options) {
+  if (Options.Has(kCostTableString)) {
+    if (!Options.Get(kCostTableString).IsArray()) {
+      return false;
+    }
+    Napi::Array Costs = Options.Get(kCostTableString).As<Napi::Array>();
+    /// Opcodes are 16 bits wide in WasmEdge, including the prefixed ones
+    if (Costs.Length() > 65536) {
+      return false;
+    }
+    Table.resize(Costs.Length());
+    for (uint32_t I = 0; I < Costs.Length(); I++) {
+      Napi::Value Cost = Costs[I];
+      if (Cost.IsUndefined()) {
+        /// Holes keep the default cost of one
+        Table[I] = 1;
+      } else if (Cost.IsNumber() &&
+                 Cost.As<Napi::Number>().Int64Value() >= 0) {
+        Table[I] = static_cast<uint64_t>(Cost.As<Napi::Number>().Int64Value());
+      } else {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 bool parseAOTConfig(const Napi::Object &Options) {
   if (Options.Has(kEnableAOTString) && Options.Get(kEnableAOTString).IsBoolean()) {
     return Options.Get(kEnableAOTString).As<Napi::Boolean>().Value();
@@ -133,21 +464,87 @@ bool parseMeasure(const Napi::Object &Options) {
   return false;
 }
 
+bool parseThreads(const Napi::Object &Options) {
+  if (Options.Has(kEnableThreadsString) &&
+      Options.Get(kEnableThreadsString).IsBoolean()) {
+    return Options.Get(kEnableThreadsString).As<Napi::Boolean>().Value();
+  }
+  return false;
+}
+
+bool parseHugePages(const Napi::Object &Options) {
+  if (Options.Has(kHugePagesString) &&
+      Options.Get(kHugePagesString).IsBoolean()) {
+    return Options.Get(kHugePagesString).As<Napi::Boolean>().Value();
+  }
+  return false;
+}
+
+bool parsePrefaultAOT(const Napi::Object &Options) {
+  if (Options.Has(kPrefaultAOTString) &&
+      Options.Get(kPrefaultAOTString).IsBoolean()) {
+    return Options.Get(kPrefaultAOTString).As<Napi::Boolean>().Value();
+  }
+  return false;
+}
+
+bool parsePrefaultMemory(const Napi::Object &Options) {
+  if (Options.Has(kPrefaultMemoryString) &&
+      Options.Get(kPrefaultMemoryString).IsBoolean()) {
+    return Options.Get(kPrefaultMemoryString).As<Napi::Boolean>().Value();
+  }
+  return false;
+}
+
 } // namespace
 
 bool Options::parse(const Napi::Object &Options) {
   if (!parseCmdArgs(getWasiCmdArgs(), Options) ||
       !parseDirs(getWasiDirs(), Options) ||
       !parseEnvs(getWasiEnvs(), Options) ||
+      !parseMemFS(getMemFS(), Options) ||
+      !parseDependencies(Dependencies, Options) ||
+      !parseAOTOptLevel(AOTOptLevel, Options) ||
+      !parseAOTCompileTimeout(AOTCompileTimeout, Options) ||
+      !parseMemoize(MemoizedFuncs, MemoizeMaxBytes, Options) ||
+      !parseSessions(MaxSessions, SessionIdleTimeout, Options) ||
+      !parseScheduler(Pool, Tenants, Options) ||
+      !parseGasLimit(GasLimit, Options) ||
+      !parseRecord(RecordPath, RecordSampleRate, Options) ||
+      !parseCostTable(CostTable, Options) ||
       !parseAllowedCmds(getAllowedCmds(), Options)) {
     return false;
   }
   setReactorMode(!parseWasiStartFlag(Options));
   setAOTMode(parseAOTConfig(Options));
-  setMeasure(parseMeasure(Options));
+  setMeasure(parseMeasure(Options) || isMetering());
+  setThreads(parseThreads(Options));
+  setHugePages(parseHugePages(Options));
+  setPrefaultAOT(parsePrefaultAOT(Options));
+  setPrefaultMemory(parsePrefaultMemory(Options));
   setAllowedCmdsAll(parseAllowedCmdsAll(Options));
+  setCaptureOutput(parseCaptureOutput(Options));
+  setAOTGenericBinary(parseAOTGenericBinary(Options));
+  setAOTDumpCompileTime(parseAOTDumpCompileTime(Options));
   return true;
 }
 
+std::string Options::getCompilerConfigKey() const {
+  std::string Key;
+  if (!AOTOptLevel.empty()) {
+    Key.append(AOTOptLevel);
+  }
+  if (AOTGenericBinary) {
+    Key.append(".generic");
+  }
+  if (Measure) {
+    Key.append(".measure");
+  }
+  if (Threads) {
+    Key.append(".threads");
+  }
+  return Key;
+}
+
 } // namespace NAPI
 } // namespace WASMEDGE
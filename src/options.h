@@ -1,6 +1,11 @@
 #pragma once
 
+#include "memfs.h"
+
+#include <cstdint>
+#include <map>
 #include <napi.h>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -14,20 +19,115 @@ static inline std::string kPreOpensString [[maybe_unused]] = "preopens";
 static inline std::string kEnvString [[maybe_unused]] = "env";
 static inline std::string kEnableAOTString [[maybe_unused]] = "EnableAOT";
 static inline std::string kEnableMeasurementString [[maybe_unused]] = "EnableMeasurement";
+static inline std::string kMemFSString [[maybe_unused]] = "memfs";
+static inline std::string kCaptureOutputString [[maybe_unused]] = "CaptureOutput";
+static inline std::string kAOTOptimizationLevelString [[maybe_unused]] = "AOTOptimizationLevel";
+static inline std::string kAOTGenericBinaryString [[maybe_unused]] = "AOTGenericBinary";
+static inline std::string kAOTDumpCompileTimeString [[maybe_unused]] = "AOTDumpCompileTime";
+static inline std::string kAOTCompileTimeoutString [[maybe_unused]] = "AOTCompileTimeout";
+static inline std::string kEnableThreadsString [[maybe_unused]] = "EnableThreads";
+static inline std::string kGasLimitString [[maybe_unused]] = "GasLimit";
+static inline std::string kCostTableString [[maybe_unused]] = "CostTable";
+static inline std::string kHugePagesString [[maybe_unused]] = "HugePages";
+static inline std::string kPrefaultAOTString [[maybe_unused]] = "PrefaultAOT";
+static inline std::string kPrefaultMemoryString [[maybe_unused]] = "PrefaultMemory";
+static inline std::string kMaxSessionsString [[maybe_unused]] = "MaxSessions";
+static inline std::string kSessionIdleTimeoutString [[maybe_unused]] = "SessionIdleTimeout";
+static inline std::string kSchedulerThreadsString [[maybe_unused]] = "SchedulerThreads";
+static inline std::string kSchedulerMinThreadsString [[maybe_unused]] = "SchedulerMinThreads";
+static inline std::string kSchedulerTargetQueueTimeString [[maybe_unused]] = "SchedulerTargetQueueTime";
+static inline std::string kSchedulerIdleTimeoutString [[maybe_unused]] = "SchedulerIdleTimeout";
+static inline std::string kSchedulerMemoryBudgetString [[maybe_unused]] = "SchedulerMemoryBudget";
+static inline std::string kTenantsString [[maybe_unused]] = "Tenants";
+static inline std::string kDependenciesString [[maybe_unused]] = "Dependencies";
+static inline std::string kRecordString [[maybe_unused]] = "Record";
+static inline std::string kRecordSampleRateString [[maybe_unused]] = "RecordSampleRate";
+static inline std::string kTenantWeightString [[maybe_unused]] = "Weight";
+static inline std::string kTenantMaxConcurrencyString [[maybe_unused]] = "MaxConcurrency";
+static inline std::string kMemoizeString [[maybe_unused]] = "Memoize";
+static inline std::string kMemoizeMaxBytesString [[maybe_unused]] = "MemoizeMaxBytes";
+
+/// Share of the RunAsync() threads given to one tenant
+struct TenantPolicy {
+  double Weight = 1;
+  /// Calls of the tenant running at the same time, 0 for unlimited
+  uint32_t MaxConcurrency = 0;
+};
+
+/// Sizing of the RunAsync() threads, each of them with its own instance
+struct PoolPolicy {
+  /// 0 for one per CPU
+  uint32_t MaxThreads = 0;
+  uint32_t MinThreads = 1;
+  /// Start a thread when a call waits longer, in ms
+  double TargetQueueTime = 5;
+  /// Stop a thread idle for longer, in ms
+  uint32_t IdleTimeout = 30000;
+  /// Linear memory of all the instances, in bytes, 0 for unlimited
+  uint64_t MemoryBudget = 0;
+};
+
+/// Wasm module linked into the instances, given by its path or its bytes
+struct DependencySource {
+  std::string Path;
+  std::vector<uint8_t> Data;
+};
+
+/// Parse { Weight, MaxConcurrency }, keeping the defaults of missing fields
+bool parseTenantPolicy(TenantPolicy &Policy, const Napi::Value &Value);
 
 class Options {
 private:
-  bool ReactorMode;
-  bool AOTMode;
-  bool Measure;
-  bool AllowedCmdsAll;
+  bool ReactorMode = true;
+  bool AOTMode = false;
+  bool Measure = false;
+  bool AllowedCmdsAll = false;
+  bool CaptureOutput = false;
+  bool AOTGenericBinary = false;
+  bool AOTDumpCompileTime = false;
+  bool Threads = false;
+  /// Back the linear memory and the AOT code with transparent huge pages
+  bool HugePages = false;
+  bool PrefaultAOT = false;
+  bool PrefaultMemory = false;
+  /// How long to wait for another VM or process compiling the same module
+  uint32_t AOTCompileTimeout = 120000;
+  /// Gas budget of each call, 0 for unlimited
+  uint64_t GasLimit = 0;
+  /// Gas cost of each instruction indexed by opcode, empty for the default
+  std::vector<uint64_t> CostTable;
+  /// Live instances kept by Session(), and their idle time before expiry
+  uint32_t MaxSessions = 64;
+  uint32_t SessionIdleTimeout = 60000;
+  PoolPolicy Pool;
+  std::map<std::string, TenantPolicy> Tenants;
+  std::string AOTOptLevel;
+  /// Pure exports whose RunString/RunUint8Array results are cached
+  std::set<std::string> MemoizedFuncs;
+  uint64_t MemoizeMaxBytes = 64 * 1024 * 1024;
   std::vector<std::string> WasiCmdArgs, WasiDirs, WasiEnvs, AllowedCmds;
+  std::map<std::string, MemFSFiles> MemFS;
+  /// Modules registered under their name before instantiating the module
+  std::map<std::string, DependencySource> Dependencies;
+  /// Log of the sampled Run* calls, empty when not recording
+  std::string RecordPath;
+  double RecordSampleRate = 1;
 
 public:
   void setReactorMode(bool Value = true) { ReactorMode = Value; }
   void setAOTMode(bool Value = true) { AOTMode = Value; }
   void setMeasure(bool Value = true) { Measure = Value; }
   void setAllowedCmdsAll(bool Value = true) { AllowedCmdsAll = Value; }
+  void setCaptureOutput(bool Value = true) { CaptureOutput = Value; }
+  void setAOTGenericBinary(bool Value = true) { AOTGenericBinary = Value; }
+  void setAOTDumpCompileTime(bool Value = true) { AOTDumpCompileTime = Value; }
+  void setThreads(bool Value = true) { Threads = Value; }
+  void setHugePages(bool Value = true) { HugePages = Value; }
+  void setPrefaultAOT(bool Value = true) { PrefaultAOT = Value; }
+  void setPrefaultMemory(bool Value = true) { PrefaultMemory = Value; }
+  void setAOTOptLevel(const std::string &Level) { AOTOptLevel = Level; }
+  void setAOTCompileTimeout(uint32_t Ms) { AOTCompileTimeout = Ms; }
+  void setGasLimit(uint64_t Limit) { GasLimit = Limit; }
   void setWasiCmdArgs(const std::vector<std::string> &WCA) {
     WasiCmdArgs = WCA;
   }
@@ -40,6 +140,43 @@ public:
   bool isAOTMode() const noexcept { return AOTMode; }
   bool isMeasuring() const noexcept { return Measure; }
   bool isAllowedCmdsAll() const noexcept { return AllowedCmdsAll; }
+  bool isCaptureOutput() const noexcept { return CaptureOutput; }
+  bool isAOTGenericBinary() const noexcept { return AOTGenericBinary; }
+  bool isAOTDumpCompileTime() const noexcept { return AOTDumpCompileTime; }
+  bool isThreadsEnabled() const noexcept { return Threads; }
+  bool isHugePages() const noexcept { return HugePages; }
+  bool isPrefaultAOT() const noexcept { return PrefaultAOT; }
+  bool isPrefaultMemory() const noexcept { return PrefaultMemory; }
+  /// Empty when the WasmEdge default level is used
+  const std::string &getAOTOptLevel() const noexcept { return AOTOptLevel; }
+  uint32_t getAOTCompileTimeout() const noexcept { return AOTCompileTimeout; }
+  uint64_t getGasLimit() const noexcept { return GasLimit; }
+  std::vector<uint64_t> &getCostTable() { return CostTable; }
+  /// Gas accounting must then be compiled into the AOT code
+  bool isMetering() const noexcept {
+    return GasLimit > 0 || !CostTable.empty();
+  }
+  bool isMemoizing() const noexcept { return !MemoizedFuncs.empty(); }
+  bool isMemoized(const std::string &FuncName) const {
+    return MemoizedFuncs.count(FuncName) > 0;
+  }
+  uint64_t getMemoizeMaxBytes() const noexcept { return MemoizeMaxBytes; }
+  const PoolPolicy &getPoolPolicy() const noexcept { return Pool; }
+  const std::map<std::string, TenantPolicy> &getTenants() const {
+    return Tenants;
+  }
+  void setTenant(const std::string &Name, const TenantPolicy &Policy) {
+    Tenants[Name] = Policy;
+  }
+  const std::string &getRecordPath() const noexcept { return RecordPath; }
+  double getRecordSampleRate() const noexcept { return RecordSampleRate; }
+  uint32_t getMaxSessions() const noexcept { return MaxSessions; }
+  uint32_t getSessionIdleTimeout() const noexcept {
+    return SessionIdleTimeout;
+  }
+  /// Identifies the options which change the compiled code, empty for the
+  /// default compiler configuration.
+  std::string getCompilerConfigKey() const;
   const std::vector<std::string> &getWasiCmdArgs() const { return WasiCmdArgs; }
   std::vector<std::string> &getWasiCmdArgs() { return WasiCmdArgs; }
   const std::vector<std::string> &getAllowedCmds() const { return AllowedCmds; }
@@ -48,6 +185,11 @@ public:
   std::vector<std::string> &getWasiDirs() { return WasiDirs; }
   const std::vector<std::string> &getWasiEnvs() const { return WasiEnvs; }
   std::vector<std::string> &getWasiEnvs() { return WasiEnvs; }
+  const std::map<std::string, MemFSFiles> &getMemFS() const { return MemFS; }
+  std::map<std::string, MemFSFiles> &getMemFS() { return MemFS; }
+  const std::map<std::string, DependencySource> &getDependencies() const {
+    return Dependencies;
+  }
   bool parse(const Napi::Object &Options);
 };
 
@@ -0,0 +1,86 @@
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+ParallelWorker::ParallelWorker(Napi::Env Env, const Napi::Object &Owner,
+                               InstanceConfig Config, std::string FuncName,
+                               std::vector<std::vector<uint8_t>> Inputs,
+                               uint32_t Threads)
+    : Napi::AsyncWorker(Env, "WasmEdgeRunParallel"),
+      Deferred(Napi::Promise::Deferred::New(Env)),
+      Owner(Napi::Persistent(Owner)), Config(std::move(Config)),
+      FuncName(std::move(FuncName)), Inputs(std::move(Inputs)),
+      Threads(Threads) {
+  Results.resize(this->Inputs.size());
+}
+
+void ParallelWorker::Execute() {
+  std::atomic<size_t> Next(0);
+  std::atomic<bool> Failed(false);
+  std::mutex ErrorMutex;
+  std::string FirstError;
+  auto Fail = [&](std::string Err) {
+    std::lock_guard<std::mutex> Lock(ErrorMutex);
+    if (!Failed.exchange(true)) {
+      FirstError = std::move(Err);
+    }
+  };
+
+  /// Instantiating is the fixed cost, so never start more threads than inputs
+  uint32_t N = static_cast<uint32_t>(
+      std::min<size_t>(std::max<uint32_t>(Threads, 1), Inputs.size()));
+  std::vector<std::thread> Workers;
+  Workers.reserve(N);
+  for (uint32_t I = 0; I < N; I++) {
+    Workers.emplace_back([&]() {
+      Instance Inst;
+      if (auto Err = Inst.init(Config); !Err.empty()) {
+        Fail(Err);
+        return;
+      }
+      for (size_t Idx = Next++; Idx < Inputs.size() && !Failed; Idx = Next++) {
+        auto &Input = Inputs[Idx];
+        uint32_t Size = static_cast<uint32_t>(Input.size());
+        if (auto Err =
+                Inst.callBytes(FuncName, Input.data(), Size, Results[Idx]);
+            !Err.empty()) {
+          Fail(Err);
+          return;
+        }
+      }
+    });
+  }
+  for (auto &Worker : Workers) {
+    Worker.join();
+  }
+  if (Failed) {
+    SetError(FirstError);
+  }
+}
+
+void ParallelWorker::OnOK() {
+  Napi::Env Env = Deferred.Env();
+  Napi::Array Array = Napi::Array::New(Env, Results.size());
+  for (size_t I = 0; I < Results.size(); I++) {
+    Napi::ArrayBuffer Buffer = Napi::ArrayBuffer::New(Env, Results[I].size());
+    std::copy(Results[I].begin(), Results[I].end(),
+              static_cast<uint8_t *>(Buffer.Data()));
+    Array.Set(static_cast<uint32_t>(I),
+              Napi::Uint8Array::New(Env, Results[I].size(), Buffer, 0,
+                                    napi_uint8_array));
+  }
+  Deferred.Resolve(Array);
+}
+
+void ParallelWorker::OnError(const Napi::Error &Error) {
+  Deferred.Reject(Error.Value());
+}
+
+} // namespace NAPI
+} // namespace WASMEDGE
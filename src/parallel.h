@@ -0,0 +1,39 @@
+#pragma once
+
+#include "instance.h"
+
+#include <cstdint>
+#include <napi.h>
+#include <string>
+#include <vector>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+/// Run one export over many inputs on native threads, each thread with its own
+/// instance of the module, and settle a promise with the results in order.
+class ParallelWorker : public Napi::AsyncWorker {
+private:
+  Napi::Promise::Deferred Deferred;
+  /// Keeps the VM, and so its host functions, alive until the promise settles
+  Napi::ObjectReference Owner;
+  InstanceConfig Config;
+  std::string FuncName;
+  std::vector<std::vector<uint8_t>> Inputs, Results;
+  uint32_t Threads;
+
+public:
+  ParallelWorker(Napi::Env Env, const Napi::Object &Owner,
+                 InstanceConfig Config, std::string FuncName,
+                 std::vector<std::vector<uint8_t>> Inputs, uint32_t Threads);
+
+  Napi::Promise getPromise() const { return Deferred.Promise(); }
+
+protected:
+  void Execute() override;
+  void OnOK() override;
+  void OnError(const Napi::Error &Error) override;
+};
+
+} // namespace NAPI
+} // namespace WASMEDGE
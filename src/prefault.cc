@@ -0,0 +1,149 @@
+#include "prefault.h"
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+namespace {
+
+struct PinnedModule {
+  void *Handle = nullptr;
+  dev_t Dev = 0;
+  ino_t Ino = 0;
+  bool HugePages = false;
+};
+
+/// Read one byte per page, so that the pages are mapped without being written
+void touchPages(const uint8_t *Begin, const uint8_t *End, size_t PageSize) {
+  for (const volatile uint8_t *P = Begin; P < End; P += PageSize) {
+    (void)*P;
+  }
+}
+
+/// Advise and fault in every mapping of the file in /proc/self/maps
+void prefaultMappings(const std::string &Path, bool HugePages) {
+#ifdef __linux__
+  const size_t PageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  std::ifstream Maps("/proc/self/maps");
+  std::string Line;
+  while (std::getline(Maps, Line)) {
+    /// Format: <begin>-<end> <perms> <offset> <dev> <inode> <path>
+    std::istringstream Fields(Line);
+    std::string Range, Perms, Offset, Dev, Inode, File;
+    if (!(Fields >> Range >> Perms >> Offset >> Dev >> Inode >> File) ||
+        File != Path || Perms.empty() || Perms[0] != 'r') {
+      continue;
+    }
+    uintptr_t Begin = 0, End = 0;
+    if (std::sscanf(Range.c_str(), "%" SCNxPTR "-%" SCNxPTR, &Begin,
+                    &End) != 2) {
+      continue;
+    }
+    void *Addr = reinterpret_cast<void *>(Begin);
+#ifdef MADV_HUGEPAGE
+    if (HugePages && Perms.size() > 2 && Perms[2] == 'x') {
+      madvise(Addr, End - Begin, MADV_HUGEPAGE);
+    }
+#endif
+    madvise(Addr, End - Begin, MADV_WILLNEED);
+    touchPages(reinterpret_cast<const uint8_t *>(Begin),
+               reinterpret_cast<const uint8_t *>(End), PageSize);
+  }
+#endif
+}
+
+} // namespace
+
+bool pinCompiledModule(const std::string &Path, bool HugePages) {
+  static std::mutex Mutex;
+  static std::unordered_map<std::string, PinnedModule> Pinned;
+
+  /// /proc/self/maps and the loader both name the file by its real path
+  char *Real = realpath(Path.c_str(), nullptr);
+  if (Real == nullptr) {
+    return false;
+  }
+  std::string Resolved(Real);
+  free(Real);
+  struct stat St;
+  if (stat(Resolved.c_str(), &St) != 0) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> Guard(Mutex);
+  PinnedModule &Module = Pinned[Resolved];
+  if (Module.Handle != nullptr) {
+    if (Module.Dev == St.st_dev && Module.Ino == St.st_ino &&
+        (Module.HugePages || !HugePages)) {
+      return true;
+    }
+    /// The file has been replaced, e.g. by CompileBytecodeTo, and the loader
+    /// would otherwise keep returning the mapping of the old code.
+    if (Module.Dev != St.st_dev || Module.Ino != St.st_ino) {
+      dlclose(Module.Handle);
+      Module.Handle = nullptr;
+    }
+  }
+  if (Module.Handle == nullptr) {
+    Module.Handle = dlopen(Resolved.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (Module.Handle == nullptr) {
+      Pinned.erase(Resolved);
+      return false;
+    }
+    Module.Dev = St.st_dev;
+    Module.Ino = St.st_ino;
+  }
+  Module.HugePages = Module.HugePages || HugePages;
+  prefaultMappings(Resolved, Module.HugePages);
+  return true;
+}
+
+void adviseLinearMemory(WasmEdge_MemoryInstanceContext *MemInst,
+                        bool HugePages, bool Prefault) {
+  if (MemInst == nullptr || (!HugePages && !Prefault)) {
+    return;
+  }
+  const uint32_t Pages = WasmEdge_MemoryInstanceGetPageSize(MemInst);
+  if (Pages == 0) {
+    return;
+  }
+  /// Wasm pages are 64 KiB, a multiple of the system page size
+  const size_t Size = static_cast<size_t>(Pages) * 65536;
+  uint8_t *Base = WasmEdge_MemoryInstanceGetPointer(MemInst, 0, 1);
+  if (Base == nullptr) {
+    return;
+  }
+#ifdef MADV_HUGEPAGE
+  if (HugePages) {
+    madvise(Base, Size, MADV_HUGEPAGE);
+  }
+#endif
+  if (Prefault) {
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(Base, Size, MADV_POPULATE_WRITE) == 0) {
+      return;
+    }
+#endif
+    /// Older kernels: write every page back, which allocates it without
+    /// changing the memory content.
+    const size_t PageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    for (volatile uint8_t *P = Base; P < Base + Size; P += PageSize) {
+      *P = *P;
+    }
+  }
+}
+
+} // namespace NAPI
+} // namespace WASMEDGE
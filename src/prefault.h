@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <wasmedge.h>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+/// Keep an AOT compiled module mapped for the lifetime of the process and
+/// fault its pages in.
+///
+/// Every call creates a new VM, which dlopen()s the module again. While this
+/// process holds its own handle, the loader reuses the existing mapping
+/// instead of mapping and faulting the code in on every call. HugePages asks
+/// for transparent huge pages on the code, which needs a kernel with
+/// CONFIG_READ_ONLY_THP_FOR_FS. Return false if the module cannot be loaded.
+bool pinCompiledModule(const std::string &Path, bool HugePages);
+
+/// Advise the kernel about the current pages of a linear memory: back them
+/// with transparent huge pages and/or fault them in now instead of during
+/// the first call. Pages added later by memory.grow are not covered.
+void adviseLinearMemory(WasmEdge_MemoryInstanceContext *MemInst,
+                        bool HugePages, bool Prefault);
+
+} // namespace NAPI
+} // namespace WASMEDGE
@@ -0,0 +1,194 @@
+#include "recorder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <random>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+namespace {
+constexpr char kMagic[4] = {'W', 'E', 'R', 'C'};
+constexpr uint32_t kVersion = 1;
+/// Offsets in a record of the fields set when the call is done
+constexpr size_t kOkAt = 5;
+constexpr size_t kDurationAt = 14;
+
+/// Logs stay open for the lifetime of the process, like the AOT cache files.
+/// Destroying them at exit writes the records still pending.
+std::mutex RecordersMutex;
+std::map<std::string, std::shared_ptr<Recorder>> Recorders;
+} // namespace
+
+CallRecord::CallRecord(Method M, const std::string &FuncName) {
+  Data.reserve(64 + FuncName.size());
+  append<uint32_t>(0);
+  append(static_cast<uint8_t>(M));
+  append<uint8_t>(0);
+  append<uint64_t>(0);
+  append<uint64_t>(0);
+  uint16_t NameSize = static_cast<uint16_t>(
+      std::min<size_t>(FuncName.size(), UINT16_MAX));
+  append(NameSize);
+  append(FuncName.data(), NameSize);
+  ArgCountAt = Data.size();
+  append<uint16_t>(0);
+}
+
+void CallRecord::append(const void *Bytes, size_t Size) {
+  const uint8_t *Begin = static_cast<const uint8_t *>(Bytes);
+  Data.insert(Data.end(), Begin, Begin + Size);
+}
+
+template <typename T> void CallRecord::patch(size_t At, T Value) {
+  std::memcpy(Data.data() + At, &Value, sizeof(T));
+}
+
+void CallRecord::addNumber(double Value) {
+  append(ArgType::Number);
+  append(Value);
+  ArgCount++;
+}
+
+void CallRecord::addBigInt(int64_t Value) {
+  append(ArgType::BigInt);
+  append(Value);
+  ArgCount++;
+}
+
+void CallRecord::addString(const std::string &Value) {
+  append(ArgType::String);
+  append(static_cast<uint32_t>(Value.size()));
+  append(Value.data(), Value.size());
+  ArgCount++;
+}
+
+void CallRecord::addBytes(const uint8_t *Bytes, size_t Size) {
+  append(ArgType::Bytes);
+  append(static_cast<uint32_t>(Size));
+  append(Bytes, Size);
+  ArgCount++;
+}
+
+void CallRecord::start() {
+  Wall = std::chrono::system_clock::now();
+  Start = std::chrono::steady_clock::now();
+}
+
+std::vector<uint8_t> CallRecord::finish(bool Ok) {
+  auto Duration = std::chrono::steady_clock::now() - Start;
+  patch<uint32_t>(0, static_cast<uint32_t>(Data.size() - sizeof(uint32_t)));
+  patch<uint8_t>(kOkAt, Ok ? 1 : 0);
+  patch<uint64_t>(kOkAt + 1,
+                  std::chrono::duration_cast<std::chrono::microseconds>(
+                      Wall.time_since_epoch())
+                      .count());
+  patch<uint64_t>(
+      kDurationAt,
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Duration).count());
+  patch<uint16_t>(ArgCountAt, ArgCount);
+  return std::move(Data);
+}
+
+Recorder::Recorder(int Fd) : Fd(Fd) {
+  Writer = std::thread([this]() { write(); });
+}
+
+Recorder::~Recorder() {
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Stopping = true;
+  }
+  Cond.notify_all();
+  Writer.join();
+  close(Fd);
+}
+
+std::shared_ptr<Recorder> Recorder::open(const std::string &Path) {
+  std::lock_guard<std::mutex> Lock(RecordersMutex);
+  if (auto It = Recorders.find(Path); It != Recorders.end()) {
+    return It->second;
+  }
+  int Fd = ::open(Path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+                  0644);
+  if (Fd < 0) {
+    return nullptr;
+  }
+  /// A log which already has records is appended to
+  struct stat Stat;
+  if (fstat(Fd, &Stat) != 0 ||
+      (Stat.st_size == 0 &&
+       (::write(Fd, kMagic, sizeof(kMagic)) != sizeof(kMagic) ||
+        ::write(Fd, &kVersion, sizeof(kVersion)) != sizeof(kVersion)))) {
+    close(Fd);
+    return nullptr;
+  }
+  std::shared_ptr<Recorder> Rec(new Recorder(Fd));
+  Recorders.emplace(Path, Rec);
+  return Rec;
+}
+
+bool Recorder::sample(double Rate) {
+  if (Rate >= 1) {
+    return true;
+  }
+  thread_local std::minstd_rand Random(std::random_device{}());
+  return std::uniform_real_distribution<double>(0, 1)(Random) < Rate;
+}
+
+void Recorder::submit(std::vector<uint8_t> Record) {
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (Pending.size() + Record.size() > kMaxPendingBytes) {
+      Dropped++;
+      return;
+    }
+    Pending.insert(Pending.end(), Record.begin(), Record.end());
+    Recorded++;
+  }
+  Cond.notify_one();
+}
+
+void Recorder::write() {
+  std::vector<uint8_t> Batch;
+  std::unique_lock<std::mutex> Lock(Mutex);
+  while (true) {
+    /// Batch the records of the calls made meanwhile into one write
+    Cond.wait_for(Lock, std::chrono::milliseconds(100),
+                  [this]() { return Stopping || !Pending.empty(); });
+    bool Stop = Stopping;
+    Batch.swap(Pending);
+    Lock.unlock();
+    size_t Done = 0;
+    while (Done < Batch.size()) {
+      ssize_t N = ::write(Fd, Batch.data() + Done, Batch.size() - Done);
+      if (N <= 0) {
+        /// The disk is full or gone, losing the log must not stop the calls
+        break;
+      }
+      Done += N;
+    }
+    Batch.clear();
+    Lock.lock();
+    if (Stop && Pending.empty()) {
+      return;
+    }
+  }
+}
+
+uint64_t Recorder::getRecorded() const {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return Recorded;
+}
+
+uint64_t Recorder::getDropped() const {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return Dropped;
+}
+
+} // namespace NAPI
+} // namespace WASMEDGE
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+/// One call of a Run* method, encoded for the log of the Record option.
+///
+/// The log starts with the magic "WERC" and a little-endian u32 version,
+/// followed by the records:
+///   u32 size of the rest of the record
+///   u8  method, see Method
+///   u8  1 if the call succeeded, 0 if it threw
+///   u64 start of the call, in µs since the Unix epoch
+///   u64 duration of the call, in ns
+///   u16 length and bytes of the function name
+///   u16 argument count, then each argument as a u8 ArgType and
+///       f64 (Number), i64 (BigInt) or u32 length and bytes (String, Bytes)
+class CallRecord {
+public:
+  enum class Method : uint8_t {
+    Int,
+    UInt,
+    Int64,
+    UInt64,
+    String,
+    Uint8Array
+  };
+  enum class ArgType : uint8_t { Number, BigInt, String, Bytes };
+
+private:
+  std::vector<uint8_t> Data;
+  size_t ArgCountAt = 0;
+  uint16_t ArgCount = 0;
+  std::chrono::system_clock::time_point Wall;
+  std::chrono::steady_clock::time_point Start;
+
+  void append(const void *Bytes, size_t Size);
+  template <typename T> void append(T Value) { append(&Value, sizeof(T)); }
+  template <typename T> void patch(size_t At, T Value);
+
+public:
+  CallRecord(Method M, const std::string &FuncName);
+
+  void addNumber(double Value);
+  void addBigInt(int64_t Value);
+  void addString(const std::string &Value);
+  void addBytes(const uint8_t *Bytes, size_t Size);
+  /// Start the clock once the arguments are encoded
+  void start();
+  /// Set the result and the duration, and return the encoded record
+  std::vector<uint8_t> finish(bool Ok);
+};
+
+/// Appends records to a log file from a background thread, so that a call
+/// only pays for encoding its record. Records are dropped instead of
+/// blocking the calls when the disk cannot keep up.
+class Recorder {
+private:
+  int Fd = -1;
+  mutable std::mutex Mutex;
+  std::condition_variable Cond;
+  std::vector<uint8_t> Pending;
+  uint64_t Recorded = 0;
+  uint64_t Dropped = 0;
+  bool Stopping = false;
+  std::thread Writer;
+
+  explicit Recorder(int Fd);
+  void write();
+
+public:
+  /// Records waiting for the writer beyond this size are dropped
+  static constexpr size_t kMaxPendingBytes = 16 * 1024 * 1024;
+
+  /// Return the recorder appending to Path, shared by all the VMs of the
+  /// process so that their records never interleave, nullptr on failure.
+  static std::shared_ptr<Recorder> open(const std::string &Path);
+  Recorder(const Recorder &) = delete;
+  Recorder &operator=(const Recorder &) = delete;
+  /// Write the pending records
+  ~Recorder();
+
+  /// Whether to record the next call, true for a fraction Rate of the calls
+  static bool sample(double Rate);
+  void submit(std::vector<uint8_t> Record);
+  uint64_t getRecorded() const;
+  uint64_t getDropped() const;
+};
+
+} // namespace NAPI
+} // namespace WASMEDGE
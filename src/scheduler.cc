@@ -0,0 +1,351 @@
+#include "scheduler.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+namespace {
+constexpr size_t kQueueTimeSamples = 1024;
+
+double msSince(Scheduler::Clock::time_point Start,
+               Scheduler::Clock::time_point End) {
+  return std::chrono::duration<double, std::milli>(End - Start).count();
+}
+} // namespace
+
+bool Scheduler::Tenant::queued() const {
+  for (const auto &Queue : Queues) {
+    if (!Queue.empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Scheduler::Scheduler(InstanceConfig Config, const PoolPolicy &Pool,
+                     DoneFunc Done)
+    : Config(std::make_shared<const InstanceConfig>(std::move(Config))),
+      Done(std::move(Done)), Pool(Pool) {
+  this->Pool.MaxThreads = std::max<uint32_t>(this->Pool.MaxThreads, 1);
+  this->Pool.MinThreads =
+      std::min(this->Pool.MinThreads, this->Pool.MaxThreads);
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    for (uint32_t I = 0; I < this->Pool.MinThreads; I++) {
+      spawn();
+    }
+  }
+  Monitor = std::thread([this]() { monitor(); });
+}
+
+Scheduler::~Scheduler() {
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Stopping = true;
+  }
+  Cond.notify_all();
+  MonitorCond.notify_all();
+  Monitor.join();
+  for (auto &W : Workers) {
+    W.Thread.join();
+  }
+}
+
+void Scheduler::spawn() {
+  Workers.emplace_back();
+  Worker &W = Workers.back();
+  Live++;
+  Starting++;
+  /// The new thread waits for the lock held by the caller
+  W.Thread = std::thread([this, &W]() { work(W); });
+}
+
+void Scheduler::setConfig(InstanceConfig NewConfig) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Config = std::make_shared<const InstanceConfig>(std::move(NewConfig));
+  Generation++;
+}
+
+Scheduler::Tenant &Scheduler::getTenant(const std::string &Name) {
+  auto It = Tenants.find(Name);
+  if (It == Tenants.end()) {
+    It = Tenants.emplace(Name, Tenant()).first;
+    It->second.QueueTimes.reserve(kQueueTimeSamples);
+  }
+  return It->second;
+}
+
+void Scheduler::setTenant(const std::string &Name, const TenantPolicy &Policy) {
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    getTenant(Name).Policy = Policy;
+  }
+  /// A higher concurrency limit may let queued calls start
+  Cond.notify_all();
+}
+
+void Scheduler::submit(std::unique_ptr<Job> J) {
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Tenant &T = getTenant(J->Tenant);
+    if (!T.queued() && T.Running == 0) {
+      /// Idle tenants do not keep their credit, they start from the least
+      /// served of the busy tenants.
+      double Min = std::numeric_limits<double>::infinity();
+      for (const auto &[Name, Other] : Tenants) {
+        if (&Other != &T && (Other.queued() || Other.Running > 0)) {
+          Min = std::min(Min, Other.Service);
+        }
+      }
+      if (Min != std::numeric_limits<double>::infinity()) {
+        T.Service = std::max(T.Service, Min);
+      }
+    }
+    J->Enqueued = Clock::now();
+    uint32_t Priority = std::min(J->Priority, kPriorities - 1);
+    T.Queues[Priority].push_back(std::move(J));
+  }
+  Cond.notify_one();
+}
+
+std::unique_ptr<Scheduler::Job> Scheduler::pick() {
+  for (uint32_t Priority = 0; Priority < kPriorities; Priority++) {
+    Tenant *Best = nullptr;
+    for (auto &[Name, T] : Tenants) {
+      if (T.Queues[Priority].empty() ||
+          (T.Policy.MaxConcurrency > 0 &&
+           T.Running >= T.Policy.MaxConcurrency)) {
+        continue;
+      }
+      if (Best == nullptr || T.Service < Best->Service) {
+        Best = &T;
+      }
+    }
+    if (Best != nullptr) {
+      std::unique_ptr<Job> J = std::move(Best->Queues[Priority].front());
+      Best->Queues[Priority].pop_front();
+      Best->Running++;
+      return J;
+    }
+  }
+  return nullptr;
+}
+
+double Scheduler::oldestWait() const {
+  auto Now = Clock::now();
+  double Oldest = -1;
+  for (const auto &[Name, T] : Tenants) {
+    if (T.Policy.MaxConcurrency > 0 && T.Running >= T.Policy.MaxConcurrency) {
+      continue;
+    }
+    for (const auto &Queue : T.Queues) {
+      if (!Queue.empty()) {
+        Oldest = std::max(Oldest, msSince(Queue.front()->Enqueued, Now));
+      }
+    }
+  }
+  return Oldest;
+}
+
+uint64_t Scheduler::memoryBytes() const {
+  uint64_t Bytes = 0;
+  for (const auto &W : Workers) {
+    Bytes += W.Exited ? 0 : W.MemoryBytes;
+  }
+  return Bytes;
+}
+
+void Scheduler::work(Worker &Self) {
+  std::unique_ptr<Instance> Inst;
+  uint64_t InstGeneration = 0;
+  std::string InitError;
+  auto Instantiate = [&](const InstanceConfig &JobConfig, uint64_t Gen) {
+    Inst = std::make_unique<Instance>();
+    InstGeneration = Gen;
+    InitError = Inst->init(JobConfig);
+    if (!InitError.empty()) {
+      Inst.reset();
+    }
+  };
+
+  while (true) {
+    std::shared_ptr<const InstanceConfig> JobConfig;
+    uint64_t JobGeneration;
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      JobConfig = Config;
+      JobGeneration = Generation;
+    }
+    /// Instantiate ahead of the calls, on a new thread or after a swap
+    if (InstGeneration != JobGeneration || (Self.Starting && !Inst)) {
+      Instantiate(*JobConfig, JobGeneration);
+    }
+
+    std::unique_ptr<Job> J;
+    {
+      std::unique_lock<std::mutex> Lock(Mutex);
+      Self.MemoryBytes =
+          Inst ? static_cast<uint64_t>(Inst->getMemoryPages()) * 65536 : 0;
+      if (Self.Starting) {
+        Self.Starting = false;
+        Starting--;
+      }
+      Idle++;
+      bool Ready = Cond.wait_for(
+          Lock, std::chrono::milliseconds(Pool.IdleTimeout), [&]() {
+            return Stopping || Retiring > 0 || Generation != InstGeneration ||
+                   (J = pick()) != nullptr;
+          });
+      Idle--;
+      if (Stopping) {
+        return;
+      }
+      if (!J) {
+        bool Retire = Retiring > 0;
+        if (Retire) {
+          Retiring--;
+        } else if (!Ready && Live > Pool.MinThreads) {
+          Retire = true;
+        }
+        if (Retire) {
+          Self.Exited = true;
+          Live--;
+          ScaleDowns++;
+          /// The monitor joins the thread
+          MonitorCond.notify_all();
+          return;
+        }
+        continue;
+      }
+      JobConfig = Config;
+      JobGeneration = Generation;
+    }
+
+    auto Start = Clock::now();
+    J->QueueTime = msSince(J->Enqueued, Start);
+    if (!Inst || InstGeneration != JobGeneration) {
+      Instantiate(*JobConfig, JobGeneration);
+    }
+    if (Inst) {
+      J->Error = Inst->callBytes(J->FuncName, J->Input.data(),
+                                 static_cast<uint32_t>(J->Input.size()),
+                                 J->Result);
+      if (!J->Error.empty()) {
+        /// The state of the instance cannot be trusted after a trap
+        Inst.reset();
+      }
+    } else {
+      J->Error = InitError;
+    }
+    J->RunTime = msSince(Start, Clock::now());
+
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      Tenant &T = getTenant(J->Tenant);
+      T.Running--;
+      (J->Error.empty() ? T.Completed : T.Failed)++;
+      T.Service += J->RunTime * 1e6 / std::max(T.Policy.Weight, 1e-3);
+      T.RunTime += J->RunTime;
+      if (T.QueueTimes.size() < kQueueTimeSamples) {
+        T.QueueTimes.push_back(J->QueueTime);
+      } else {
+        T.QueueTimes[T.NextQueueTime] = J->QueueTime;
+      }
+      T.NextQueueTime = (T.NextQueueTime + 1) % kQueueTimeSamples;
+      T.QueueTimeMax = std::max(T.QueueTimeMax, J->QueueTime);
+    }
+    /// A slot of the tenant is free again
+    Cond.notify_all();
+    Done(std::move(J));
+  }
+}
+
+void Scheduler::monitor() {
+  /// Check often enough to react within the target
+  auto Tick = std::chrono::duration<double, std::milli>(
+      std::clamp(Pool.TargetQueueTime / 2, 1.0, 100.0));
+  std::unique_lock<std::mutex> Lock(Mutex);
+  while (!Stopping) {
+    MonitorCond.wait_for(Lock, Tick);
+    if (Stopping) {
+      break;
+    }
+    for (auto It = Workers.begin(); It != Workers.end();) {
+      if (It->Exited) {
+        It->Thread.join();
+        It = Workers.erase(It);
+      } else {
+        ++It;
+      }
+    }
+
+    uint64_t Memory = memoryBytes();
+    uint64_t PerInstance = 0;
+    for (const auto &W : Workers) {
+      PerInstance = std::max(PerInstance, W.MemoryBytes);
+    }
+    if (Pool.MemoryBudget > 0 && Memory > Pool.MemoryBudget &&
+        Live - Retiring > Pool.MinThreads && Idle > Retiring) {
+      /// Over the budget, e.g. after the instances grew their memories
+      Retiring++;
+      Cond.notify_all();
+      continue;
+    }
+
+    double Wait = oldestWait();
+    bool Grow = Wait >= 0 && Idle == 0 && Starting == 0 &&
+                Live < Pool.MaxThreads &&
+                (Live == 0 || Wait > Pool.TargetQueueTime) &&
+                (Pool.MemoryBudget == 0 ||
+                 Memory + PerInstance <= Pool.MemoryBudget);
+    if (Grow) {
+      spawn();
+      ScaleUps++;
+    }
+  }
+}
+
+std::map<std::string, Scheduler::TenantStatistics>
+Scheduler::getStatistics() const {
+  std::map<std::string, TenantStatistics> Stats;
+  std::lock_guard<std::mutex> Lock(Mutex);
+  for (const auto &[Name, T] : Tenants) {
+    TenantStatistics &S = Stats[Name];
+    for (const auto &Queue : T.Queues) {
+      S.Queued += Queue.size();
+    }
+    S.Running = T.Running;
+    S.Completed = T.Completed;
+    S.Failed = T.Failed;
+    S.RunTime = T.RunTime;
+    S.QueueTimeMax = T.QueueTimeMax;
+    if (!T.QueueTimes.empty()) {
+      std::vector<double> Sorted(T.QueueTimes);
+      std::sort(Sorted.begin(), Sorted.end());
+      auto At = [&Sorted](double P) {
+        return Sorted[std::min(Sorted.size() - 1,
+                               static_cast<size_t>(P * Sorted.size()))];
+      };
+      S.QueueTimeP50 = At(0.5);
+      S.QueueTimeP99 = At(0.99);
+    }
+  }
+  return Stats;
+}
+
+Scheduler::PoolStatistics Scheduler::getPoolStatistics() const {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  PoolStatistics S;
+  S.Threads = Live;
+  S.Starting = Starting;
+  S.Idle = Idle;
+  S.MemoryBytes = memoryBytes();
+  S.ScaleUps = ScaleUps;
+  S.ScaleDowns = ScaleDowns;
+  return S;
+}
+
+} // namespace NAPI
+} // namespace WASMEDGE
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "instance.h"
+#include "options.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+/// Runs the calls of many tenants on a fixed set of native threads.
+///
+/// Priority classes are strict: a call of a lower class only starts when no
+/// call of a higher class can. Within a class, the tenant with the least
+/// execution time received, divided by its weight, goes first, so a tenant
+/// flooding expensive calls only gets its share of the threads. A tenant
+/// which was idle starts from the share of the busy ones instead of the
+/// credit it saved meanwhile. Each thread keeps its own instance, so calls do
+/// not share state, like RunParallel().
+///
+/// The threads scale between the limits of the PoolPolicy: a new one is
+/// started when a call which could run waits longer than the target, and a
+/// thread idle for longer than the timeout stops. A new thread instantiates
+/// the module before taking calls, so no call ever waits for it. The pool
+/// does not grow beyond the memory budget, measured from the linear memories
+/// of the instances, and idle threads stop while it is exceeded.
+class Scheduler {
+public:
+  using Clock = std::chrono::steady_clock;
+  static constexpr uint32_t kPriorities = 3;
+
+  struct Job {
+    uint64_t Id = 0;
+    std::string Tenant;
+    uint32_t Priority = 1;
+    std::string FuncName;
+    std::vector<uint8_t> Input;
+    /// Set when done, Error is empty on success
+    std::vector<uint8_t> Result;
+    std::string Error;
+    Clock::time_point Enqueued;
+    double QueueTime = 0;
+    double RunTime = 0;
+  };
+  /// Called on the thread which ran the job
+  using DoneFunc = std::function<void(std::unique_ptr<Job>)>;
+
+  struct TenantStatistics {
+    uint64_t Queued = 0;
+    uint64_t Running = 0;
+    uint64_t Completed = 0;
+    uint64_t Failed = 0;
+    /// Queue time percentiles of the recent calls, in ms
+    double QueueTimeP50 = 0;
+    double QueueTimeP99 = 0;
+    double QueueTimeMax = 0;
+    /// Execution time of all the calls, in ms
+    double RunTime = 0;
+  };
+
+  struct PoolStatistics {
+    uint64_t Threads = 0;
+    uint64_t Starting = 0;
+    uint64_t Idle = 0;
+    /// Linear memory of all the instances, in bytes
+    uint64_t MemoryBytes = 0;
+    uint64_t ScaleUps = 0;
+    uint64_t ScaleDowns = 0;
+  };
+
+private:
+  struct Worker {
+    std::thread Thread;
+    bool Starting = true;
+    bool Exited = false;
+    uint64_t MemoryBytes = 0;
+  };
+
+  struct Tenant {
+    TenantPolicy Policy;
+    std::deque<std::unique_ptr<Job>> Queues[kPriorities];
+    uint64_t Running = 0;
+    uint64_t Completed = 0;
+    uint64_t Failed = 0;
+    /// Execution time received divided by the weight, in ns
+    double Service = 0;
+    double RunTime = 0;
+    /// Ring of the last queue times
+    std::vector<double> QueueTimes;
+    size_t NextQueueTime = 0;
+    double QueueTimeMax = 0;
+
+    bool queued() const;
+  };
+
+  mutable std::mutex Mutex;
+  std::condition_variable Cond;
+  std::map<std::string, Tenant> Tenants;
+  std::shared_ptr<const InstanceConfig> Config;
+  uint64_t Generation = 0;
+  DoneFunc Done;
+  PoolPolicy Pool;
+  std::list<Worker> Workers;
+  std::thread Monitor;
+  std::condition_variable MonitorCond;
+  /// Threads which have not exited, of which starting and idle ones
+  uint32_t Live = 0;
+  uint32_t Starting = 0;
+  uint32_t Idle = 0;
+  /// Idle threads asked to stop because of the memory budget
+  uint32_t Retiring = 0;
+  uint64_t ScaleUps = 0;
+  uint64_t ScaleDowns = 0;
+  bool Stopping = false;
+
+  Tenant &getTenant(const std::string &Name);
+  /// Return the next job which may start, nullptr if there is none
+  std::unique_ptr<Job> pick();
+  /// Queue time of the oldest call which could start, in ms
+  double oldestWait() const;
+  uint64_t memoryBytes() const;
+  void spawn();
+  void work(Worker &Self);
+  void monitor();
+
+public:
+  Scheduler(InstanceConfig Config, const PoolPolicy &Pool, DoneFunc Done);
+  Scheduler(const Scheduler &) = delete;
+  Scheduler &operator=(const Scheduler &) = delete;
+  /// Wait for the running calls, queued calls are dropped
+  ~Scheduler();
+
+  /// The following calls run on new instances of this configuration
+  void setConfig(InstanceConfig NewConfig);
+  void setTenant(const std::string &Name, const TenantPolicy &Policy);
+  void submit(std::unique_ptr<Job> J);
+  std::map<std::string, TenantStatistics> getStatistics() const;
+  PoolStatistics getPoolStatistics() const;
+};
+
+} // namespace NAPI
+} // namespace WASMEDGE
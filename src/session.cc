@@ -0,0 +1,97 @@
+#include "session.h"
+
+#include <algorithm>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+void SessionPool::setMaxSessions(uint32_t Max) {
+  MaxSessions = std::max<uint32_t>(Max, 1);
+  evict();
+}
+
+Instance *SessionPool::find(const std::string &Key) {
+  auto It = Index.find(Key);
+  if (It == Index.end()) {
+    ++Misses;
+    return nullptr;
+  }
+  if (It->second->Generation != Generation) {
+    auto Node = It->second;
+    Index.erase(It);
+    Entries.erase(Node);
+    ++Misses;
+    return nullptr;
+  }
+  ++Hits;
+  It->second->LastUsed = Clock::now();
+  Entries.splice(Entries.begin(), Entries, It->second);
+  return It->second->Inst.get();
+}
+
+Instance *SessionPool::insert(std::string Key,
+                              std::shared_ptr<WasmEdge_ASTModuleContext> AST,
+                              std::unique_ptr<Instance> Inst) {
+  erase(Key);
+  Entries.push_front(
+      Entry{std::move(Key), std::move(AST), std::move(Inst), Clock::now(),
+            Generation});
+  Index.emplace(Entries.front().Key, Entries.begin());
+  /// At least one session is kept, so the new one is never evicted
+  evict();
+  return Entries.front().Inst.get();
+}
+
+bool SessionPool::erase(const std::string &Key) {
+  auto It = Index.find(Key);
+  if (It == Index.end()) {
+    return false;
+  }
+  auto Node = It->second;
+  Index.erase(It);
+  Entries.erase(Node);
+  return true;
+}
+
+void SessionPool::evict() {
+  while (Entries.size() > MaxSessions) {
+    Index.erase(Entries.back().Key);
+    Entries.pop_back();
+    ++Evictions;
+  }
+}
+
+void SessionPool::expire() {
+  if (IdleTimeout.count() <= 0) {
+    return;
+  }
+  const auto Deadline = Clock::now() - IdleTimeout;
+  /// The list is ordered by last use, the idle sessions are at the back
+  while (!Entries.empty() && Entries.back().LastUsed < Deadline) {
+    Index.erase(Entries.back().Key);
+    Entries.pop_back();
+    ++Expirations;
+  }
+}
+
+void SessionPool::setGasLimit(uint64_t Limit) {
+  for (auto &E : Entries) {
+    E.Inst->setGasLimit(Limit);
+  }
+}
+
+void SessionPool::clear() {
+  Index.clear();
+  Entries.clear();
+}
+
+uint64_t SessionPool::getMemoryPages() const {
+  uint64_t Pages = 0;
+  for (const auto &E : Entries) {
+    Pages += E.Inst->getMemoryPages();
+  }
+  return Pages;
+}
+
+} // namespace NAPI
+} // namespace WASMEDGE
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "instance.h"
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+/// Live instances keyed by a session key, so that the state a module keeps
+/// in its linear memory survives between the calls of the same key.
+///
+/// The least recently used session is ended when a new one would exceed the
+/// limit, and sessions idle for longer than the timeout are ended by the next
+/// expire().
+class SessionPool {
+public:
+  using Clock = std::chrono::steady_clock;
+
+private:
+  struct Entry {
+    std::string Key;
+    /// Keeps the module of the instance alive after a SwapModule()
+    std::shared_ptr<WasmEdge_ASTModuleContext> AST;
+    std::unique_ptr<Instance> Inst;
+    Clock::time_point LastUsed;
+    /// Sessions of an older generation run a replaced module
+    uint64_t Generation;
+  };
+  std::list<Entry> Entries;
+  std::unordered_map<std::string_view, std::list<Entry>::iterator> Index;
+  uint32_t MaxSessions = 64;
+  std::chrono::milliseconds IdleTimeout{60000};
+  uint64_t Hits = 0;
+  uint64_t Misses = 0;
+  uint64_t Evictions = 0;
+  uint64_t Expirations = 0;
+  uint64_t Generation = 0;
+
+  void evict();
+
+public:
+  void setMaxSessions(uint32_t Max);
+  void setIdleTimeout(std::chrono::milliseconds Timeout) {
+    IdleTimeout = Timeout;
+  }
+  /// Return nullptr on a miss, or when the session runs a module replaced
+  /// since it was created, which ends it. The pointer is valid until the next
+  /// insert, erase or expire.
+  Instance *find(const std::string &Key);
+  Instance *insert(std::string Key,
+                   std::shared_ptr<WasmEdge_ASTModuleContext> AST,
+                   std::unique_ptr<Instance> Inst);
+  /// Return false if there is no such session
+  bool erase(const std::string &Key);
+  /// Change the gas budget of the following calls of every session
+  void setGasLimit(uint64_t Limit);
+  /// The module has been replaced, the next call of every session starts a
+  /// new instance
+  void markStale() noexcept { Generation++; }
+  /// End the sessions idle for longer than the timeout
+  void expire();
+  void clear();
+
+  uint64_t getHits() const noexcept { return Hits; }
+  uint64_t getMisses() const noexcept { return Misses; }
+  uint64_t getEvictions() const noexcept { return Evictions; }
+  uint64_t getExpirations() const noexcept { return Expirations; }
+  uint64_t getSessions() const noexcept { return Entries.size(); }
+  /// Linear memory of all the sessions, in 64 KiB pages
+  uint64_t getMemoryPages() const;
+};
+
+} // namespace NAPI
+} // namespace WASMEDGE
@@ -0,0 +1,99 @@
+#include "sharedmodule.h"
+#include "compiler.h"
+#include "instance.h"
+#include "universal.h"
+
+namespace WASMEDGE {
+namespace NAPI {
+
+namespace {
+
+inline bool endsWith(const std::string &S, const std::string &Suffix) {
+  return S.length() >= Suffix.length() &&
+         S.compare(S.length() - Suffix.length(), std::string::npos, Suffix) ==
+             0;
+}
+
+} // namespace
+
+std::string prepareSharedModule(SharedModule &Module, const Options &Options,
+                                bool &Compiled) {
+  Bytecode &BC = Module.BC;
+  bool IsSharedObject = BC.isFile() && endsWith(BC.getPath(), ".so");
+  if (!BC.isCompiled() && !IsSharedObject) {
+    Module.ImportModules.clear();
+    /// Scanned first, the imports of embedded code cannot be read. A file is
+    /// read once for both.
+    const std::vector<uint8_t> &Code = BC.getData();
+    Module.ImportsKnown =
+        Bytecode::getImportModuleNames(Code, Module.ImportModules);
+    useEmbeddedCode(BC, Code, Options);
+  }
+  if (Options.isAOTMode() && !BC.isCompiled() && !IsSharedObject) {
+    /// On failure BC is left as wasm and runs in the interpreter
+    bool WaitExpired = false;
+    compileToCache(BC, Module.Cache, Options, WaitExpired);
+  }
+  if (BC.isCompiled()) {
+    Module.Cache.dumpToFile(BC.getData());
+    BC.setPath(Module.Cache.getPath());
+  }
+  Compiled = BC.isFile() && endsWith(BC.getPath(), ".so");
+
+  WasmEdge_ConfigureContext *Conf = WasmEdge_ConfigureCreate();
+  addProposals(Conf, Options.isThreadsEnabled());
+  WasmEdge_LoaderContext *Loader = WasmEdge_LoaderCreate(Conf);
+  WasmEdge_ASTModuleContext *AST = nullptr;
+  WasmEdge_Result Res;
+  if (BC.isFile()) {
+    Res = WasmEdge_LoaderParseFromFile(Loader, &AST, BC.getPath().c_str());
+  } else {
+    Res = WasmEdge_LoaderParseFromBuffer(Loader, &AST, BC.getData().data(),
+                                         BC.getData().size());
+  }
+  WasmEdge_LoaderDelete(Loader);
+  if (WasmEdge_ResultOK(Res)) {
+    WasmEdge_ValidatorContext *Validator = WasmEdge_ValidatorCreate(Conf);
+    Res = WasmEdge_ValidatorValidate(Validator, AST);
+    WasmEdge_ValidatorDelete(Validator);
+  }
+  WasmEdge_ConfigureDelete(Conf);
+  if (!WasmEdge_ResultOK(Res)) {
+    if (AST != nullptr) {
+      WasmEdge_ASTModuleDelete(AST);
+    }
+    return WasmEdge_ResultGetMessage(Res);
+  }
+  Module.AST =
+      std::shared_ptr<WasmEdge_ASTModuleContext>(AST, WasmEdge_ASTModuleDelete);
+  return {};
+}
+
+SharedModuleRegistry &SharedModuleRegistry::getInstance() {
+  /// Shared by every addon instance (main thread and workers) in the process.
+  static SharedModuleRegistry Registry;
+  return Registry;
+}
+
+uint64_t SharedModuleRegistry::add(std::shared_ptr<const SharedModule> Module) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  uint64_t Id = NextId++;
+  Modules.emplace(Id, std::move(Module));
+  return Id;
+}
+
+std::shared_ptr<const SharedModule> SharedModuleRegistry::find(uint64_t Id) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  if (auto It = Modules.find(Id); It != Modules.end()) {
+    return It->second;
+  }
+  return nullptr;
+}
+
+bool SharedModuleRegistry::remove(uint64_t Id) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return Modules.erase(Id) > 0;
+}
+
+} // namespace NAPI
+} // namespace WASMEDGE
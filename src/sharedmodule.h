@@ -0,0 +1,56 @@
+#pragma once
+
+#include "bytecode.h"
+#include "cache.h"
+#include "options.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <wasmedge.h>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+static inline std::string kSharedModuleString [[maybe_unused]] = "SharedModule";
+
+/// A wasm module which has been loaded (and AOT compiled when enabled) once
+/// and can be reused by VMs living in other worker_threads.
+struct SharedModule {
+  Bytecode BC;
+  WASMEDGE::NAPI::Cache Cache;
+  /// Only read when instantiating, so it can be used from several threads
+  std::shared_ptr<WasmEdge_ASTModuleContext> AST;
+  /// Imports scanned before compilation, the compiled file cannot be scanned
+  std::set<std::string> ImportModules;
+  bool ImportsKnown = false;
+};
+
+/// Scan the imports, AOT compile when enabled, then parse and validate a
+/// module whose BC is set, without touching JS, e.g. on a worker thread. Set
+/// Compiled when the module runs AOT compiled code. Return an error message,
+/// empty on success.
+std::string prepareSharedModule(SharedModule &Module, const Options &Options,
+                                bool &Compiled);
+
+/// Process-wide table of shared modules. Handles are plain integers so they
+/// can be posted between workers with the structured clone algorithm.
+class SharedModuleRegistry {
+private:
+  std::mutex Mutex;
+  uint64_t NextId = 1;
+  std::unordered_map<uint64_t, std::shared_ptr<const SharedModule>> Modules;
+
+public:
+  static SharedModuleRegistry &getInstance();
+
+  uint64_t add(std::shared_ptr<const SharedModule> Module);
+  std::shared_ptr<const SharedModule> find(uint64_t Id);
+  bool remove(uint64_t Id);
+};
+
+} // namespace NAPI
+} // namespace WASMEDGE
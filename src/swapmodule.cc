@@ -0,0 +1,44 @@
+#include "swapmodule.h"
+
+#include <chrono>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+SwapModuleWorker::SwapModuleWorker(Napi::Env Env, const Napi::Object &Owner,
+                                   const WASMEDGE::NAPI::Options &Options,
+                                   std::shared_ptr<SharedModule> Module,
+                                   ApplyFunc Apply)
+    : Napi::AsyncWorker(Env, "WasmEdgeSwapModule"),
+      Deferred(Napi::Promise::Deferred::New(Env)),
+      Owner(Napi::Persistent(Owner)), Options(Options),
+      Module(std::move(Module)), Apply(std::move(Apply)) {}
+
+void SwapModuleWorker::Execute() {
+  auto Start = std::chrono::steady_clock::now();
+  if (auto Err = prepareSharedModule(*Module, Options, Compiled);
+      !Err.empty()) {
+    SetError(Err);
+    return;
+  }
+  PrepareMs = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - Start)
+                  .count();
+}
+
+void SwapModuleWorker::OnOK() {
+  Napi::Env Env = Deferred.Env();
+  bool Applied = Apply(std::move(Module));
+  Napi::Object Result = Napi::Object::New(Env);
+  Result.Set("Applied", Napi::Boolean::New(Env, Applied));
+  Result.Set("Compiled", Napi::Boolean::New(Env, Compiled));
+  Result.Set("PrepareTime", Napi::Number::New(Env, PrepareMs));
+  Deferred.Resolve(Result);
+}
+
+void SwapModuleWorker::OnError(const Napi::Error &Error) {
+  Deferred.Reject(Error.Value());
+}
+
+} // namespace NAPI
+} // namespace WASMEDGE
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "options.h"
+#include "sharedmodule.h"
+
+#include <functional>
+#include <memory>
+#include <napi.h>
+#include <string>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+/// Prepare a new version of the module of a VM off the JS thread, then hand
+/// it to Apply on the JS thread, between two calls, and settle a promise.
+class SwapModuleWorker : public Napi::AsyncWorker {
+public:
+  /// Return false when a more recent swap has been applied in the meantime
+  using ApplyFunc = std::function<bool(std::shared_ptr<const SharedModule>)>;
+
+private:
+  Napi::Promise::Deferred Deferred;
+  /// Keeps the VM alive until the promise settles
+  Napi::ObjectReference Owner;
+  WASMEDGE::NAPI::Options Options;
+  std::shared_ptr<SharedModule> Module;
+  ApplyFunc Apply;
+  bool Compiled = false;
+  double PrepareMs = 0;
+
+public:
+  SwapModuleWorker(Napi::Env Env, const Napi::Object &Owner,
+                   const WASMEDGE::NAPI::Options &Options,
+                   std::shared_ptr<SharedModule> Module, ApplyFunc Apply);
+
+  Napi::Promise getPromise() const { return Deferred.Promise(); }
+
+protected:
+  void Execute() override;
+  void OnOK() override;
+  void OnError(const Napi::Error &Error) override;
+};
+
+} // namespace NAPI
+} // namespace WASMEDGE
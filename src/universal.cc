@@ -0,0 +1,196 @@
+#include "universal.h"
+#include "compiler.h"
+#include "utils.h"
+
+#include <boost/functional/hash.hpp>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sys/utsname.h>
+#include <wasmedge.h>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+namespace {
+
+/// Bumped whenever the layout of the section changes
+constexpr uint32_t kUniversalFormat = 1;
+
+enum UniversalFlags : uint8_t {
+  kGeneric = 0x01,
+  kMeasure = 0x02,
+  kThreads = 0x04,
+};
+
+/// Identity of the host CPU for code compiled for its features
+std::string hostCPU() {
+  std::ifstream CPUInfo("/proc/cpuinfo");
+  std::string Line, Model, Features;
+  while (std::getline(CPUInfo, Line) && (Model.empty() || Features.empty())) {
+    auto Field = [&Line](const char *Name) {
+      return Line.compare(0, std::char_traits<char>::length(Name), Name) == 0;
+    };
+    if (Model.empty() && (Field("model name") || Field("CPU part"))) {
+      Model = Line;
+    } else if (Features.empty() && (Field("flags") || Field("Features"))) {
+      Features = Line;
+    }
+  }
+  if (Features.empty()) {
+    return {};
+  }
+  size_t Hash = 0;
+  boost::hash_combine(Hash, Model);
+  boost::hash_combine(Hash, Features);
+  return std::to_string(Hash);
+}
+
+/// OS, architecture and WasmEdge version, plus the CPU for native code. The
+/// compiled code only runs with the same ones.
+std::string hostTarget(bool Generic) {
+  struct utsname Name;
+  if (uname(&Name) != 0) {
+    return {};
+  }
+  std::string Target = std::string(Name.sysname) + "-" + Name.machine +
+                       "-wasmedge-" + WasmEdge_VersionGet();
+  if (!Generic) {
+    std::string CPU = hostCPU();
+    if (CPU.empty()) {
+      return {};
+    }
+    Target += "-" + CPU;
+  }
+  return Target;
+}
+
+/// Whether the compiler honours AOTGenericBinary. Older releases only print a
+/// notice and emit code for the build CPU, which must be recorded as such.
+bool isGenericBuild(const Options &Options) {
+#if WASMEDGE_NAPI_VERSION_AT_LEAST(0, 8, 2)
+  return Options.isAOTGenericBinary();
+#else
+  return false;
+#endif
+}
+
+void appendU32(std::vector<uint8_t> &Out, uint32_t Value) {
+  do {
+    uint8_t Byte = Value & 0x7f;
+    Value >>= 7;
+    Out.push_back(Value ? (Byte | 0x80) : Byte);
+  } while (Value);
+}
+
+bool readU32(const uint8_t *&Cur, const uint8_t *End, uint32_t &Value) {
+  Value = 0;
+  for (uint32_t Shift = 0; Shift < 35 && Cur < End; Shift += 7) {
+    uint8_t Byte = *Cur++;
+    Value |= static_cast<uint32_t>(Byte & 0x7f) << Shift;
+    if ((Byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+bool compileUniversalTo(Bytecode &BC, const Options &Options,
+                        const std::string &Path) {
+  std::vector<uint8_t> Plain = BC.getData();
+  if (Plain.size() < 8 || !BC.isWasm()) {
+    return false;
+  }
+  /// Recompiling a universal file replaces its code
+  if (size_t Begin, Payload, End; Bytecode::findCustomSection(
+          Plain, kUniversalSectionString, Begin, Payload, End)) {
+    Plain.erase(Plain.begin() + Begin, Plain.begin() + End);
+  }
+  bool Generic = isGenericBuild(Options);
+  std::string Target = hostTarget(Generic);
+  if (Target.empty()) {
+    return false;
+  }
+
+  Bytecode Module;
+  Module.setData(Plain);
+  std::string TmpPath = Cache::getTmpPath(Path);
+  std::string SoPath = TmpPath + ".so";
+  if (!compileBytecodeTo(Module, Options, SoPath)) {
+    return false;
+  }
+  std::ifstream SoFile(SoPath, std::ios::binary);
+  std::vector<uint8_t> Code((std::istreambuf_iterator<char>(SoFile)),
+                            std::istreambuf_iterator<char>());
+  SoFile.close();
+  std::remove(SoPath.c_str());
+
+  std::vector<uint8_t> Content;
+  appendU32(Content, kUniversalSectionString.size());
+  Content.insert(Content.end(), kUniversalSectionString.begin(),
+                 kUniversalSectionString.end());
+  appendU32(Content, kUniversalFormat);
+  appendU32(Content, Target.size());
+  Content.insert(Content.end(), Target.begin(), Target.end());
+  Content.push_back((Generic ? kGeneric : 0) |
+                    (Options.isMeasuring() ? kMeasure : 0) |
+                    (Options.isThreadsEnabled() ? kThreads : 0));
+  Content.insert(Content.end(), Code.begin(), Code.end());
+  Plain.push_back(0x00);
+  appendU32(Plain, Content.size());
+  Plain.insert(Plain.end(), Content.begin(), Content.end());
+
+  /// Replace the file atomically, other processes may be loading it
+  std::ofstream File(TmpPath, std::ios::binary);
+  File.write(reinterpret_cast<const char *>(Plain.data()), Plain.size());
+  File.close();
+  if (!File || std::rename(TmpPath.c_str(), Path.c_str()) != 0) {
+    std::remove(TmpPath.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool useEmbeddedCode(Bytecode &BC, const std::vector<uint8_t> &Data,
+                     const Options &Options) {
+  size_t Begin, Payload, End;
+  if (!Bytecode::findCustomSection(Data, kUniversalSectionString, Begin,
+                                   Payload, End)) {
+    return false;
+  }
+  const uint8_t *Cur = Data.data() + Payload;
+  const uint8_t *Last = Data.data() + End;
+  uint32_t Format, TargetSize;
+  if (readU32(Cur, Last, Format) && Format == kUniversalFormat &&
+      readU32(Cur, Last, TargetSize) &&
+      static_cast<size_t>(Last - Cur) > TargetSize) {
+    std::string Target(reinterpret_cast<const char *>(Cur), TargetSize);
+    Cur += TargetSize;
+    uint8_t Flags = *Cur++;
+    /// The proposals must agree, and gas cannot be metered without the
+    /// counters compiled in
+    if (Target == hostTarget(Flags & kGeneric) &&
+        ((Flags & kThreads) != 0) == Options.isThreadsEnabled() &&
+        ((Flags & kMeasure) != 0 || !Options.isMeasuring()) &&
+        Last - Cur >= 4) {
+      Bytecode Code;
+      Code.setData(std::vector<uint8_t>(Cur, Last));
+      if (Code.isCompiled()) {
+        BC = std::move(Code);
+        return true;
+      }
+    }
+  }
+  /// Data may be the buffer of BC, copy it before replacing it
+  std::vector<uint8_t> Plain;
+  Plain.reserve(Data.size() - (End - Begin));
+  Plain.insert(Plain.end(), Data.begin(), Data.begin() + Begin);
+  Plain.insert(Plain.end(), Data.begin() + End, Data.end());
+  BC.setData(Plain);
+  return false;
+}
+
+} // namespace NAPI
+} // namespace WASMEDGE
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "bytecode.h"
+#include "options.h"
+
+#include <string>
+
+namespace WASMEDGE {
+namespace NAPI {
+
+/// Custom section carrying the AOT compiled code of a universal wasm file
+static inline std::string kUniversalSectionString [[maybe_unused]] =
+    "wasmedge-napi-aot";
+
+/// Compile BC and write the wasm module with the compiled code embedded in a
+/// custom section to Path. Runtimes which do not know the section ignore it,
+/// so the file runs everywhere and only compiled on hosts matching the target.
+bool compileUniversalTo(Bytecode &BC, const Options &Options,
+                        const std::string &Path);
+
+/// When BC is a universal wasm file, point BC to its compiled code if it was
+/// compiled for this host, this WasmEdge version and compatible options, and
+/// return true. Otherwise the section is removed, so that BC is interpreted
+/// or compiled like the plain module: BC then holds the stripped bytes, which
+/// are what the AOT cache hashes and compiles, even for a path input. Other
+/// inputs are left as they are. Data holds the bytes of BC, read once by the
+/// caller.
+bool useEmbeddedCode(Bytecode &BC, const std::vector<uint8_t> &Data,
+                     const Options &Options);
+
+} // namespace NAPI
+} // namespace WASMEDGE
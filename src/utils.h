@@ -39,6 +39,15 @@ namespace filesystem = experimental::filesystem;
 
 #undef EXPERIMENTAL
 
+// Some WasmEdge C API functions are only available in newer releases.
+// Must be used after including wasmedge.h.
+#define WASMEDGE_NAPI_VERSION_AT_LEAST(Major, Minor, Patch)                   \
+  (WASMEDGE_VERSION_MAJOR > (Major) ||                                         \
+   (WASMEDGE_VERSION_MAJOR == (Major) &&                                       \
+    (WASMEDGE_VERSION_MINOR > (Minor) ||                                       \
+     (WASMEDGE_VERSION_MINOR == (Minor) &&                                     \
+      WASMEDGE_VERSION_PATCH >= (Patch)))))
+
 namespace WASMEDGE {
 namespace NAPI {
 
@@ -4,9 +4,13 @@
 #include <wasmedge.h>
 
 #include <boost/functional/hash.hpp>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
 #include <iostream>
-
-Napi::FunctionReference WasmEdgeAddon::Constructor;
+#include <map>
+#include <thread>
+#include <unistd.h>
 
 Napi::Object WasmEdgeAddon::Init(Napi::Env Env, Napi::Object Exports) {
   Napi::HandleScope Scope(Env);
@@ -16,26 +20,59 @@ Napi::Object WasmEdgeAddon::Init(Napi::Env Env, Napi::Object Exports) {
   Napi::Function Func = DefineClass(
       Env, "VM",
       {InstanceMethod("GetStatistics", &WasmEdgeAddon::GetStatistics),
+       InstanceMethod("GetCallStatistics", &WasmEdgeAddon::GetCallStatistics),
+       InstanceMethod("SetGasLimit", &WasmEdgeAddon::SetGasLimit),
        InstanceMethod("Start", &WasmEdgeAddon::RunStart),
+       InstanceMethod("StartWith", &WasmEdgeAddon::RunStartWith),
        InstanceMethod("Compile", &WasmEdgeAddon::RunCompile),
+       InstanceMethod("Precompile", &WasmEdgeAddon::RunPrecompile),
        InstanceMethod("Run", &WasmEdgeAddon::Run),
        InstanceMethod("RunInt", &WasmEdgeAddon::RunInt),
        InstanceMethod("RunUInt", &WasmEdgeAddon::RunUInt),
        InstanceMethod("RunInt64", &WasmEdgeAddon::RunInt64),
        InstanceMethod("RunUInt64", &WasmEdgeAddon::RunUInt64),
        InstanceMethod("RunString", &WasmEdgeAddon::RunString),
-       InstanceMethod("RunUint8Array", &WasmEdgeAddon::RunUint8Array)});
-
-  Constructor = Napi::Persistent(Func);
-  Constructor.SuppressDestruct();
+       InstanceMethod("RunParallel", &WasmEdgeAddon::RunParallel),
+       InstanceMethod("RunUint8Array", &WasmEdgeAddon::RunUint8Array),
+       InstanceMethod("RunAsync", &WasmEdgeAddon::RunAsync),
+       InstanceMethod("SetTenant", &WasmEdgeAddon::SetTenant),
+       InstanceMethod("GetSchedulerStatistics",
+                      &WasmEdgeAddon::GetSchedulerStatistics),
+       InstanceMethod("SessionRun", &WasmEdgeAddon::SessionRun),
+       InstanceMethod("SessionEnd", &WasmEdgeAddon::SessionEnd),
+       InstanceMethod("RunValue", &WasmEdgeAddon::RunValue),
+       InstanceMethod("Pipeline", &WasmEdgeAddon::RunPipeline),
+       InstanceMethod("StreamBegin", &WasmEdgeAddon::StreamBegin),
+       InstanceMethod("StreamWrite", &WasmEdgeAddon::StreamWrite),
+       InstanceMethod("StreamEnd", &WasmEdgeAddon::StreamEnd),
+       InstanceMethod("Share", &WasmEdgeAddon::Share),
+       InstanceMethod("SwapModule", &WasmEdgeAddon::SwapModule),
+       StaticMethod("ReleaseSharedModule",
+                    &WasmEdgeAddon::ReleaseSharedModule)});
+
+  // Keep the constructor per environment so that the addon can be loaded by
+  // several worker_threads at the same time.
+  Napi::FunctionReference *Constructor = new Napi::FunctionReference();
+  *Constructor = Napi::Persistent(Func);
+  Env.SetInstanceData(Constructor);
 
   Exports.Set("VM", Func);
   return Exports;
 }
 
 namespace {
+inline bool isSharedModuleHandle(const Napi::Value &Value) {
+  return Value.IsObject() &&
+         Value.As<Napi::Object>().Has(WASMEDGE::NAPI::kSharedModuleString) &&
+         Value.As<Napi::Object>()
+             .Get(WASMEDGE::NAPI::kSharedModuleString)
+             .IsNumber();
+}
+
 inline bool checkInputWasmFormat(const Napi::CallbackInfo &Info) {
-  return Info.Length() <= 0 || (!Info[0].IsString() && !Info[0].IsTypedArray());
+  return Info.Length() <= 0 ||
+         (!Info[0].IsString() && !Info[0].IsTypedArray() &&
+          !isSharedModuleHandle(Info[0]));
 }
 
 inline bool isWasiOptionsProvided(const Napi::CallbackInfo &Info) {
@@ -56,17 +93,145 @@ inline uint64_t castFromU32ToU64(uint32_t L, uint32_t H) {
   return static_cast<uint64_t>(L) | (static_cast<uint64_t>(H) << 32);
 }
 
+inline Napi::Uint8Array toUint8Array(Napi::Env Env,
+                                     const std::vector<uint8_t> &Data) {
+  Napi::ArrayBuffer Buffer = Napi::ArrayBuffer::New(Env, Data.size());
+  std::copy(Data.begin(), Data.end(), static_cast<uint8_t *>(Buffer.Data()));
+  return Napi::Uint8Array::New(Env, Data.size(), Buffer, 0, napi_uint8_array);
+}
+
+/// Serialize the arguments of a Run* call the way PrepareResource() passes
+/// them, so that equal keys mean equal inputs. The map hashes the key with the
+/// standard (non-cryptographic) string hash.
+inline bool makeMemoKey(const Napi::CallbackInfo &Info, std::string &Key) {
+  if (Info.Length() == 0) {
+    return false;
+  }
+  auto appendBytes = [&Key](char Tag, const void *Data, uint32_t Size) {
+    Key.push_back(Tag);
+    Key.append(reinterpret_cast<const char *>(&Size), sizeof(Size));
+    Key.append(static_cast<const char *>(Data), Size);
+  };
+  Key = Info[0].As<Napi::String>().Utf8Value();
+  Key.push_back('\0');
+  for (std::size_t I = 1; I < Info.Length(); I++) {
+    if (Info[I].IsNumber()) {
+      int32_t V = Info[I].As<Napi::Number>().Int32Value();
+      appendBytes('n', &V, sizeof(V));
+    } else if (Info[I].IsString()) {
+      std::string S = Info[I].As<Napi::String>().Utf8Value();
+      appendBytes('s', S.data(), S.size());
+    } else if (Info[I].IsTypedArray() &&
+               Info[I].As<Napi::TypedArray>().TypedArrayType() ==
+                   napi_uint8_array) {
+      Napi::TypedArray Array = Info[I].As<Napi::TypedArray>();
+      appendBytes('b',
+                  static_cast<uint8_t *>(Array.ArrayBuffer().Data()) +
+                      Array.ByteOffset(),
+                  Array.ByteLength());
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+static inline std::string kWasiModuleName [[maybe_unused]] =
+    "wasi_snapshot_preview1";
+static inline std::string kProcessModuleName [[maybe_unused]] =
+    "wasmedge_process";
+
+/// Export taking and returning i64 values directly, instead of splitting the
+/// arguments into (low, high) pairs and writing the result to offset 0.
+inline bool usesNativeI64(const WasmEdge_FunctionTypeContext *Type) {
+  if (Type == nullptr || WasmEdge_FunctionTypeGetReturnsLength(Type) != 1) {
+    return false;
+  }
+  enum WasmEdge_ValType Ret;
+  WasmEdge_FunctionTypeGetReturns(Type, &Ret, 1);
+  uint32_t ParamLen = WasmEdge_FunctionTypeGetParametersLength(Type);
+  std::vector<enum WasmEdge_ValType> Params(ParamLen);
+  WasmEdge_FunctionTypeGetParameters(Type, Params.data(), ParamLen);
+  for (auto Param : Params) {
+    if (Param != WasmEdge_ValType_I64) {
+      return false;
+    }
+  }
+  return Ret == WasmEdge_ValType_I64;
+}
+
+inline double threadCpuTimeMs() {
+  struct timespec Ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &Ts);
+  return Ts.tv_sec * 1e3 + Ts.tv_nsec / 1e6;
+}
+
 inline bool endsWith(const std::string &S, const std::string &Suffix) {
   return S.length() >= Suffix.length() &&
          S.compare(S.length() - Suffix.length(), std::string::npos, Suffix) ==
              0;
 }
 
+/// Records a sampled Run* call into the log of the Record option when it
+/// returns. Calls with arguments which cannot be replayed, and calls which
+/// did not run the wasm function, are not recorded.
+class RecordScope {
+private:
+  using CallRecord = WASMEDGE::NAPI::CallRecord;
+  WASMEDGE::NAPI::Recorder *Rec = nullptr;
+  std::unique_ptr<CallRecord> Record;
+  Napi::Env Env;
+
+public:
+  RecordScope(WASMEDGE::NAPI::Recorder *Rec, double Rate,
+              const Napi::CallbackInfo &Info, CallRecord::Method M)
+      : Rec(Rec), Env(Info.Env()) {
+    if (Rec == nullptr || Info.Length() == 0 || !Info[0].IsString() ||
+        !WASMEDGE::NAPI::Recorder::sample(Rate)) {
+      return;
+    }
+    Record = std::make_unique<CallRecord>(
+        M, Info[0].As<Napi::String>().Utf8Value());
+    for (size_t I = 1; I < Info.Length(); I++) {
+      Napi::Value Arg = Info[I];
+      if (Arg.IsNumber()) {
+        Record->addNumber(Arg.As<Napi::Number>().DoubleValue());
+      } else if (Arg.IsBigInt()) {
+        bool Lossless;
+        Record->addBigInt(Arg.As<Napi::BigInt>().Int64Value(&Lossless));
+      } else if (Arg.IsString()) {
+        Record->addString(Arg.As<Napi::String>().Utf8Value());
+      } else if (Arg.IsTypedArray() &&
+                 Arg.As<Napi::TypedArray>().TypedArrayType() ==
+                     napi_uint8_array) {
+        Napi::TypedArray Array = Arg.As<Napi::TypedArray>();
+        Record->addBytes(static_cast<uint8_t *>(Array.ArrayBuffer().Data()) +
+                             Array.ByteOffset(),
+                         Array.ByteLength());
+      } else {
+        Record.reset();
+        return;
+      }
+    }
+    Record->start();
+  }
+  RecordScope(const RecordScope &) = delete;
+  RecordScope &operator=(const RecordScope &) = delete;
+  /// The call returns without executing, e.g. from the Memoize cache
+  void cancel() { Record.reset(); }
+  ~RecordScope() {
+    if (Record) {
+      Rec->submit(Record->finish(!Env.IsExceptionPending()));
+    }
+  }
+};
+
 } // namespace
 
 WasmEdgeAddon::WasmEdgeAddon(const Napi::CallbackInfo &Info)
     : Napi::ObjectWrap<WasmEdgeAddon>(Info), Configure(nullptr), VM(nullptr),
-      MemInst(nullptr), WasiMod(nullptr), Inited(false) {
+      MemInst(nullptr), WasiMod(nullptr), Inited(false), Streaming(false),
+      CompileWaitExpired(false), ImportsKnown(false) {
   Napi::Env Env = Info.Env();
   Napi::HandleScope Scope(Env);
 
@@ -85,16 +250,48 @@ WasmEdgeAddon::WasmEdgeAddon(const Napi::CallbackInfo &Info)
   if (isWasiOptionsProvided(Info)) {
     // Get a WASI options object
     Napi::Object WasiOptions = Info[1].As<Napi::Object>();
-    if (!Options.parse(WasiOptions)) {
+    if (!Options.parse(WasiOptions) || !HostMods.parse(WasiOptions)) {
       napi_throw_error(
           Info.Env(), "Error",
           WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::ParseOptionsFailed).c_str());
       return;
     }
+    Memo.setMaxBytes(Options.getMemoizeMaxBytes());
+    Sessions.setMaxSessions(Options.getMaxSessions());
+    Sessions.setIdleTimeout(
+        std::chrono::milliseconds(Options.getSessionIdleTimeout()));
+    /// Only the first VM of the process needing a dependency prepares it
+    if (!WASMEDGE::NAPI::resolveDependencies(Options.getDependencies(),
+                                             Options, Deps)
+             .empty()) {
+      napi_throw_error(
+          Info.Env(), "Error",
+          WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::LoadDependencyFailed)
+              .c_str());
+      return;
+    }
+    DepImportsKnown =
+        WASMEDGE::NAPI::collectDependencyImports(Deps, DepImports);
+    if (!Options.getRecordPath().empty() &&
+        !(Rec = WASMEDGE::NAPI::Recorder::open(Options.getRecordPath()))) {
+      napi_throw_error(
+          Info.Env(), "Error",
+          WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::OpenRecordFailed).c_str());
+      return;
+    }
   }
 
   // Handle input wasm
-  if (Info[0].IsString()) {
+  if (isSharedModuleHandle(Info[0])) {
+    // Module shared by another VM, possibly from another worker
+    if (!LoadSharedModule(Info[0].As<Napi::Object>())) {
+      napi_throw_error(
+          Info.Env(), "Error",
+          WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::InvalidSharedModule)
+              .c_str());
+      return;
+    }
+  } else if (Info[0].IsString()) {
     // Wasm file path
     BC.setPath(std::move(Info[0].As<Napi::String>().Utf8Value()));
   } else if (Info[0].IsTypedArray() &&
@@ -123,38 +320,92 @@ WasmEdgeAddon::WasmEdgeAddon(const Napi::CallbackInfo &Info)
   }
 }
 
-void WasmEdgeAddon::InitVM(const Napi::CallbackInfo &Info) {
+void WasmEdgeAddon::InitVM(const Napi::CallbackInfo &Info, bool SetupOnly) {
   if (Inited) {
     return;
   }
+  this->SetupOnly = SetupOnly;
 
   Store = WasmEdge_StoreCreate();
   Configure = WasmEdge_ConfigureCreate();
-  Stat = WasmEdge_StatisticsCreate();
-  WasmEdge_ConfigureAddProposal(Configure,
-                                WasmEdge_Proposal_BulkMemoryOperations);
-  WasmEdge_ConfigureAddProposal(Configure, WasmEdge_Proposal_ReferenceTypes);
-  WasmEdge_ConfigureAddProposal(Configure, WasmEdge_Proposal_SIMD);
-  WasmEdge_ConfigureAddHostRegistration(Configure,
-                                        WasmEdge_HostRegistration_Wasi);
-  WasmEdge_ConfigureAddHostRegistration(
-      Configure, WasmEdge_HostRegistration_WasmEdge_Process);
+  WASMEDGE::NAPI::addProposals(Configure, Options.isThreadsEnabled());
+  /// Only create the host modules which the wasm module imports
+  ScanImports();
+  if (IsImported(kWasiModuleName)) {
+    WasmEdge_ConfigureAddHostRegistration(Configure,
+                                          WasmEdge_HostRegistration_Wasi);
+  }
+  if (IsImported(kProcessModuleName)) {
+    WasmEdge_ConfigureAddHostRegistration(
+        Configure, WasmEdge_HostRegistration_WasmEdge_Process);
+  }
   VM = WasmEdge_VMCreate(Configure, Store);
 
   WasmEdge_LogSetErrorLevel();
 
-  WasmEdge_ImportObjectContext *ProcObject = WasmEdge_VMGetImportModuleContext(
-      VM, WasmEdge_HostRegistration_WasmEdge_Process);
-  std::vector<const char *> AllowCmds;
-  AllowCmds.reserve(Options.getAllowedCmds().size());
-  for (auto &cmd : Options.getAllowedCmds()) {
-    AllowCmds.push_back(cmd.c_str());
+  /// Gas is metered per call, every call gets a new VM
+  WasmEdge_StatisticsContext *Stat = WasmEdge_VMGetStatisticsContext(VM);
+  if (!Options.getCostTable().empty()) {
+    WasmEdge_StatisticsSetCostTable(Stat, Options.getCostTable().data(),
+                                    Options.getCostTable().size());
+  }
+  if (Options.getGasLimit() > 0) {
+    WasmEdge_StatisticsSetCostLimit(Stat, Options.getGasLimit());
+  }
+
+  if (!HostMods.empty() && !HostMods.registerTo(VM)) {
+    napi_throw_error(
+        Info.Env(), "Error",
+        WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::RegisterHostFunctionsFailed)
+            .c_str());
+  }
+
+  if (!Deps.empty() &&
+      !WASMEDGE::NAPI::registerDependencies(VM, Deps).empty()) {
+    napi_throw_error(
+        Info.Env(), "Error",
+        WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::LoadDependencyFailed).c_str());
+  }
+
+  if (WasmEdge_ImportObjectContext *ProcObject =
+          WasmEdge_VMGetImportModuleContext(
+              VM, WasmEdge_HostRegistration_WasmEdge_Process)) {
+    std::vector<const char *> AllowCmds;
+    AllowCmds.reserve(Options.getAllowedCmds().size());
+    for (auto &cmd : Options.getAllowedCmds()) {
+      AllowCmds.push_back(cmd.c_str());
+    }
+    WasmEdge_ImportObjectInitWasmEdgeProcess(ProcObject, AllowCmds.data(),
+                                             AllowCmds.size(),
+                                             Options.isAllowedCmdsAll());
   }
-  WasmEdge_ImportObjectInitWasmEdgeProcess(ProcObject, AllowCmds.data(),
-                                           AllowCmds.size(),
-                                           Options.isAllowedCmdsAll());
 
   Inited = true;
+  CallStart = std::chrono::steady_clock::now();
+  CallCpuStart = threadCpuTimeMs();
+}
+
+void WasmEdgeAddon::ScanImports() {
+  if (ImportsScanned || BC.isCompiled() ||
+      (BC.isFile() && endsWith(BC.getPath(), ".so"))) {
+    return;
+  }
+  ImportModules.clear();
+  /// A universal wasm file runs its embedded code when built for this host.
+  /// The imports are scanned first, the compiled code cannot be scanned, and
+  /// a file is read once for both.
+  const std::vector<uint8_t> &Code = BC.getData();
+  ImportsKnown =
+      WASMEDGE::NAPI::Bytecode::getImportModuleNames(Code, ImportModules);
+  WASMEDGE::NAPI::useEmbeddedCode(BC, Code, Options);
+  ImportsScanned = true;
+}
+
+bool WasmEdgeAddon::IsImported(const std::string &ModuleName) const {
+  /// Register everything when the imports are unknown, e.g. for AOT input
+  return !ImportsKnown || !DepImportsKnown ||
+         ImportModules.count(ModuleName) > 0 ||
+         DepImports.count(ModuleName) > 0;
 }
 
 void WasmEdgeAddon::FiniVM() {
@@ -162,21 +413,47 @@ void WasmEdgeAddon::FiniVM() {
     return;
   }
 
-  Stat = WasmEdge_VMGetStatisticsContext(VM);
+  /// The statistics are owned by the VM, read them before deleting it
+  if (!SetupOnly) {
+    const WasmEdge_StatisticsContext *Stat =
+        WasmEdge_VMGetStatisticsContext(VM);
+    LastCall.InstrCount = WasmEdge_StatisticsGetInstrCount(Stat);
+    LastCall.GasCost = WasmEdge_StatisticsGetTotalCost(Stat);
+    LastCall.InstrPerSecond = WasmEdge_StatisticsGetInstrPerSecond(Stat);
+    LastCall.WallTime = std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - CallStart)
+                            .count();
+    LastCall.CpuTime = threadCpuTimeMs() - CallCpuStart;
+    LastCall.GasLimitExceeded = false;
+    TotalCalls.InstrCount += LastCall.InstrCount;
+    TotalCalls.GasCost += LastCall.GasCost;
+    TotalCalls.WallTime += LastCall.WallTime;
+    TotalCalls.CpuTime += LastCall.CpuTime;
+  }
   WasmEdge_VMDelete(VM);
   VM = nullptr;
+  HostMods.releaseImportObjects();
   WasmEdge_StoreDelete(Store);
   Store = nullptr;
   WasmEdge_ConfigureDelete(Configure);
   Configure = nullptr;
   MemInst = nullptr;
   WasiMod = nullptr;
+  MemFS.unmount();
 
   Inited = false;
+  Streaming = false;
 }
 
 void WasmEdgeAddon::InitWasi(const Napi::CallbackInfo &Info,
                              const std::string &FuncName) {
+  InitWasi(Info, FuncName, Options.getWasiCmdArgs(), Options.getWasiEnvs());
+}
+
+void WasmEdgeAddon::InitWasi(const Napi::CallbackInfo &Info,
+                             const std::string &FuncName,
+                             const std::vector<std::string> &Args,
+                             const std::vector<std::string> &Envs) {
   WasiMod =
       WasmEdge_VMGetImportModuleContext(VM, WasmEdge_HostRegistration_Wasi);
 
@@ -185,6 +462,7 @@ void WasmEdgeAddon::InitWasi(const Napi::CallbackInfo &Info,
     if (BC.isFile() && endsWith(BC.getPath(), ".so")) {
       // BC is already the compiled filename, do nothing
     } else if (!BC.isCompiled()) {
+      /// On failure BC is left as wasm and runs in the interpreter
       Compile();
     }
     /// After Compile(), {Bytecode, FilePath} -> {FilePath}
@@ -194,14 +472,25 @@ void WasmEdgeAddon::InitWasi(const Napi::CallbackInfo &Info,
     LoadWasm(Info);
   }
 
+  if (WasiMod != nullptr) {
+    InitWasiModule(Args, Envs);
+  }
+
+  if (Options.isAOTMode()) {
+    InitReactor(Info);
+  }
+}
+
+void WasmEdgeAddon::InitWasiModule(const std::vector<std::string> &Args,
+                                   const std::vector<std::string> &Envs) {
   std::vector<const char *> WasiCmdArgs;
-  WasiCmdArgs.reserve(Options.getWasiCmdArgs().size());
-  for (auto &cmd : Options.getWasiCmdArgs()) {
+  WasiCmdArgs.reserve(Args.size());
+  for (auto &cmd : Args) {
     WasiCmdArgs.push_back(cmd.c_str());
   }
   std::vector<const char *> WasiEnvs;
-  WasiEnvs.reserve(Options.getWasiEnvs().size());
-  for (auto &env : Options.getWasiEnvs()) {
+  WasiEnvs.reserve(Envs.size());
+  for (auto &env : Envs) {
     WasiEnvs.push_back(env.c_str());
   }
   std::vector<const char *> WasiDirs;
@@ -209,64 +498,40 @@ void WasmEdgeAddon::InitWasi(const Napi::CallbackInfo &Info,
   for (auto &dir : Options.getWasiDirs()) {
     WasiDirs.push_back(dir.c_str());
   }
+  for (auto &dir : MemFS.getPreopens()) {
+    WasiDirs.push_back(dir.c_str());
+  }
   WasmEdge_ImportObjectInitWASI(WasiMod, WasiCmdArgs.data(), WasiCmdArgs.size(),
                                 WasiEnvs.data(), WasiEnvs.size(),
                                 WasiDirs.data(), WasiDirs.size(), nullptr, 0);
-
-  if (Options.isAOTMode()) {
-    InitReactor(Info);
-  }
 }
 
 void WasmEdgeAddon::ThrowNapiError(const Napi::CallbackInfo &Info,
                                    ErrorType Type) {
   FiniVM();
+  if (Type == ErrorType::ExecutionFailed && Options.getGasLimit() > 0 &&
+      LastCall.GasCost >= Options.getGasLimit()) {
+    LastCall.GasLimitExceeded = true;
+    Type = ErrorType::GasLimitExceeded;
+  }
   napi_throw_error(Info.Env(), "Error",
                    WASMEDGE::NAPI::ErrorMsgs.at(Type).c_str());
 }
 
-bool WasmEdgeAddon::Compile() {
-  /// Calculate hash and path.
-  Cache.init(BC.getData());
-
-  /// If the compiled bytecode existed, return directly.
-  if (!Cache.isCached()) {
-    /// Cache not found. Compile wasm bytecode
-    if (auto Res = CompileBytecodeTo(Cache.getPath()); !Res) {
-      return false;
-    }
-  }
-
-  /// After compiled Bytecode, the output will be written to a FilePath.
-  BC.setPath(Cache.getPath());
-  return true;
+bool WasmEdgeAddon::Compile(bool *Compiled) {
+  return WASMEDGE::NAPI::compileToCache(BC, Cache, Options, CompileWaitExpired,
+                                        Compiled);
 }
 
 bool WasmEdgeAddon::CompileBytecodeTo(const std::string &Path) {
-  /// Make sure BC is in FilePath mode
-  BC.setFileMode();
-
-  if (Options.isMeasuring()) {
-    WasmEdge_ConfigureCompilerSetCostMeasuring(Configure, true);
-    WasmEdge_ConfigureCompilerSetInstructionCounting(Configure, true);
-  }
-  WasmEdge_CompilerContext *CompilerCxt = WasmEdge_CompilerCreate(Configure);
-  WasmEdge_Result Res =
-      WasmEdge_CompilerCompile(CompilerCxt, BC.getPath().c_str(), Path.c_str());
-  if (!WasmEdge_ResultOK(Res)) {
-    std::cerr << "WasmEdge Compile failed. Error: "
-              << WasmEdge_ResultGetMessage(Res);
-    return false;
-  }
-  return true;
+  return WASMEDGE::NAPI::compileBytecodeTo(BC, Options, Path);
 }
 
-void WasmEdgeAddon::PrepareResource(const Napi::CallbackInfo &Info,
+void WasmEdgeAddon::PrepareResource(Napi::Env Env,
+                                    const std::vector<Napi::Value> &Values,
                                     std::vector<WasmEdge_Value> &Args,
                                     IntKind IntT) {
-  for (std::size_t I = 1; I < Info.Length(); I++) {
-    Napi::Value Arg = Info[I];
-    uint32_t MallocSize = 0, MallocAddr = 0;
+  for (const Napi::Value &Arg : Values) {
     if (Arg.IsNumber()) {
       switch (IntT) {
       case IntKind::SInt32:
@@ -288,61 +553,117 @@ void WasmEdgeAddon::PrepareResource(const Napi::CallbackInfo &Info,
       }
       default:
         napi_throw_error(
-            Info.Env(), "Error",
+            Env, "Error",
             WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::NAPIUnkownIntType).c_str());
         return;
       }
       continue;
     } else if (Arg.IsString()) {
       std::string StrArg = Arg.As<Napi::String>().Utf8Value();
-      MallocSize = StrArg.length();
+      if (!PassBytes(Env, reinterpret_cast<const uint8_t *>(StrArg.data()),
+                     StrArg.size(), Args)) {
+        return;
+      }
     } else if (Arg.IsTypedArray() &&
                Arg.As<Napi::TypedArray>().TypedArrayType() ==
                    napi_uint8_array) {
-      Napi::ArrayBuffer DataBuffer = Arg.As<Napi::TypedArray>().ArrayBuffer();
-      MallocSize = DataBuffer.ByteLength();
+      // The array can be a view of a larger buffer, e.g. a pooled Buffer
+      Napi::TypedArray Array = Arg.As<Napi::TypedArray>();
+      uint8_t *Data = static_cast<uint8_t *>(Array.ArrayBuffer().Data()) +
+                      Array.ByteOffset();
+      if (!PassBytes(Env, Data, Array.ByteLength(), Args)) {
+        return;
+      }
     } else {
       // TODO: support other types
       napi_throw_error(
-          Info.Env(), "Error",
+          Env, "Error",
           WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::UnsupportedArgumentType)
               .c_str());
       return;
     }
+  }
+}
 
-    // Malloc
-    WasmEdge_Value Params = WasmEdge_ValueGenI32(MallocSize);
-    WasmEdge_Value Rets;
-    WasmEdge_String FuncName =
-        WasmEdge_StringCreateByCString("__wbindgen_malloc");
-    WasmEdge_Result Res =
-        WasmEdge_VMExecute(VM, FuncName, &Params, 1, &Rets, 1);
-    WasmEdge_StringDelete(FuncName);
-    if (!WasmEdge_ResultOK(Res)) {
-      napi_throw_error(Info.Env(), "Error", WasmEdge_ResultGetMessage(Res));
-      return;
-    }
-    MallocAddr = (uint32_t)WasmEdge_ValueGetI32(Rets);
+bool WasmEdgeAddon::PassBytes(Napi::Env Env, const uint8_t *Data,
+                              uint32_t Size,
+                              std::vector<WasmEdge_Value> &Args) {
+  // Malloc
+  WasmEdge_Value Params = WasmEdge_ValueGenI32(Size);
+  WasmEdge_Value Rets;
+  WasmEdge_String FuncName =
+      WasmEdge_StringCreateByCString("__wbindgen_malloc");
+  WasmEdge_Result Res = WasmEdge_VMExecute(VM, FuncName, &Params, 1, &Rets, 1);
+  WasmEdge_StringDelete(FuncName);
+  if (!WasmEdge_ResultOK(Res)) {
+    napi_throw_error(Env, "Error", WasmEdge_ResultGetMessage(Res));
+    return false;
+  }
+  uint32_t MallocAddr = (uint32_t)WasmEdge_ValueGetI32(Rets);
+
+  // Prepare arguments and memory data
+  Args.emplace_back(WasmEdge_ValueGenI32(MallocAddr));
+  Args.emplace_back(WasmEdge_ValueGenI32(Size));
+  WasmEdge_MemoryInstanceSetData(MemInst, const_cast<uint8_t *>(Data),
+                                 MallocAddr, Size);
+  return true;
+}
 
-    // Prepare arguments and memory data
-    Args.emplace_back(WasmEdge_ValueGenI32(MallocAddr));
-    Args.emplace_back(WasmEdge_ValueGenI32(MallocSize));
+const WasmEdge_FunctionTypeContext *
+WasmEdgeAddon::GetFuncType(const std::string &FuncName) {
+  WasmEdge_String Name = WasmEdge_StringCreateByCString(FuncName.c_str());
+  const WasmEdge_FunctionTypeContext *Type =
+      WasmEdge_VMGetFunctionType(VM, Name);
+  WasmEdge_StringDelete(Name);
+  return Type;
+}
 
-    // Setup memory
-    if (Arg.IsString()) {
-      std::string StrArg = Arg.As<Napi::String>().Utf8Value();
-      std::vector<uint8_t> StrArgVec(StrArg.begin(), StrArg.end());
-      WasmEdge_MemoryInstanceSetData(MemInst, StrArgVec.data(), MallocAddr,
-                                     StrArgVec.size());
-    } else if (Arg.IsTypedArray() &&
-               Arg.As<Napi::TypedArray>().TypedArrayType() ==
-                   napi_uint8_array) {
-      Napi::ArrayBuffer DataBuffer = Arg.As<Napi::TypedArray>().ArrayBuffer();
-      uint8_t *Data = (uint8_t *)DataBuffer.Data();
-      WasmEdge_MemoryInstanceSetData(MemInst, Data, MallocAddr,
-                                     DataBuffer.ByteLength());
-    }
+bool WasmEdgeAddon::GetResultPtrLen(const Napi::CallbackInfo &Info,
+                                    const WasmEdge_Value *Rets,
+                                    uint32_t ResultMemAddr, uint32_t &Addr,
+                                    uint32_t &Len) {
+  if (Rets != nullptr) {
+    /// Multi-value return, nothing to read from the linear memory
+    Addr = static_cast<uint32_t>(WasmEdge_ValueGetI32(Rets[0]));
+    Len = static_cast<uint32_t>(WasmEdge_ValueGetI32(Rets[1]));
+    return true;
+  }
+  uint8_t ResultMem[8];
+  WasmEdge_Result Res =
+      WasmEdge_MemoryInstanceGetData(MemInst, ResultMem, ResultMemAddr, 8);
+  if (!WasmEdge_ResultOK(Res)) {
+    ThrowNapiError(Info, ErrorType::BadMemoryAccess);
+    return false;
+  }
+  Addr = castFromBytesToU32(ResultMem, 0);
+  Len = castFromBytesToU32(ResultMem, 4);
+  return true;
+}
+
+bool WasmEdgeAddon::ReadResultBytes(const Napi::CallbackInfo &Info,
+                                    uint32_t ResultDataAddr,
+                                    uint32_t ResultDataLen,
+                                    std::vector<uint8_t> &Result) {
+  Result.resize(ResultDataLen);
+  WasmEdge_Result Res = WasmEdge_MemoryInstanceGetData(
+      MemInst, Result.data(), ResultDataAddr, ResultDataLen);
+  if (!WasmEdge_ResultOK(Res)) {
+    ThrowNapiError(Info, ErrorType::BadMemoryAccess);
+    return false;
+  }
+  ReleaseResource(Info, ResultDataAddr, ResultDataLen);
+  return true;
+}
+
+void WasmEdgeAddon::PrepareResource(const Napi::CallbackInfo &Info,
+                                    std::vector<WasmEdge_Value> &Args,
+                                    IntKind IntT) {
+  std::vector<Napi::Value> Values;
+  Values.reserve(Info.Length());
+  for (std::size_t I = 1; I < Info.Length(); I++) {
+    Values.push_back(Info[I]);
   }
+  PrepareResource(Info.Env(), Values, Args, IntT);
 }
 
 void WasmEdgeAddon::PrepareResource(const Napi::CallbackInfo &Info,
@@ -350,6 +671,33 @@ void WasmEdgeAddon::PrepareResource(const Napi::CallbackInfo &Info,
   PrepareResource(Info, Args, IntKind::Default);
 }
 
+bool WasmEdgeAddon::PrepareI64Resource(const Napi::CallbackInfo &Info,
+                                       std::vector<WasmEdge_Value> &Args,
+                                       IntKind IntT) {
+  bool HasBigInt = false;
+  for (std::size_t I = 1; I < Info.Length(); I++) {
+    if (Info[I].IsNumber()) {
+      Args.emplace_back(
+          WasmEdge_ValueGenI64(Info[I].As<Napi::Number>().Int64Value()));
+    } else if (Info[I].IsBigInt()) {
+      bool Lossless;
+      Napi::BigInt Value = Info[I].As<Napi::BigInt>();
+      Args.emplace_back(WasmEdge_ValueGenI64(
+          IntT == IntKind::UInt64
+              ? static_cast<int64_t>(Value.Uint64Value(&Lossless))
+              : Value.Int64Value(&Lossless)));
+      HasBigInt = true;
+    } else {
+      napi_throw_error(
+          Info.Env(), "Error",
+          WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::UnsupportedArgumentType)
+              .c_str());
+      return false;
+    }
+  }
+  return HasBigInt;
+}
+
 void WasmEdgeAddon::ReleaseResource(const Napi::CallbackInfo &Info,
                                     const uint32_t Offset,
                                     const uint32_t Size) {
@@ -370,29 +718,110 @@ void WasmEdgeAddon::ReleaseResource(const Napi::CallbackInfo &Info,
 }
 
 Napi::Value WasmEdgeAddon::RunStart(const Napi::CallbackInfo &Info) {
+  if (IsStreaming(Info)) {
+    return Napi::Value();
+  }
+
+  // The args option is expected to be like process.argv, drop the node
+  // binary and the script name. Work on a copy so that Start() can be called
+  // again with the same arguments.
+  std::vector<std::string> Args = Options.getWasiCmdArgs();
+  Args.erase(Args.begin(), Args.begin() + std::min<size_t>(2, Args.size()));
+  return RunCommand(Info, Args, Options.getWasiEnvs());
+}
+
+Napi::Value WasmEdgeAddon::RunStartWith(const Napi::CallbackInfo &Info) {
+  if (IsStreaming(Info)) {
+    return Napi::Value();
+  }
+
+  // Per-run arguments and environment variables, in the same format as the
+  // args and env options. args is the full argv of the wasm application.
+  WASMEDGE::NAPI::Options RunOptions;
+  if (Info.Length() > 0 && Info[0].IsObject()) {
+    Napi::Object RunOpts = Info[0].As<Napi::Object>();
+    if (!RunOptions.parse(RunOpts)) {
+      napi_throw_error(
+          Info.Env(), "Error",
+          WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::ParseOptionsFailed).c_str());
+      return Napi::Value();
+    }
+    return RunCommand(Info, RunOptions.getWasiCmdArgs(),
+                      RunOpts.Has(WASMEDGE::NAPI::kEnvString)
+                          ? RunOptions.getWasiEnvs()
+                          : Options.getWasiEnvs());
+  }
+  return RunCommand(Info, RunOptions.getWasiCmdArgs(), Options.getWasiEnvs());
+}
+
+Napi::Value WasmEdgeAddon::RunCommand(const Napi::CallbackInfo &Info,
+                                      const std::vector<std::string> &Args,
+                                      const std::vector<std::string> &Envs) {
   InitVM(Info);
 
   std::string FuncName = "_start";
-  const std::vector<std::string> &WasiCmdArgs = Options.getWasiCmdArgs();
-  Options.getWasiCmdArgs().erase(WasiCmdArgs.begin(), WasiCmdArgs.begin() + 2);
+  if (!Options.getMemFS().empty() && !MemFS.mount(Options.getMemFS())) {
+    ThrowNapiError(Info, ErrorType::MountMemFSFailed);
+    return Napi::Value();
+  }
 
-  InitWasi(Info, FuncName);
+  InitWasi(Info, FuncName, Args, Envs);
+  /// Parse and validate the module only once, every run instantiates it
+  /// again from the cached AST.
+  LoadAST(Info);
+  if (Info.Env().IsExceptionPending()) {
+    return Napi::Value();
+  }
+
+  WASMEDGE::NAPI::StdioCapture Capture;
+  if (Options.isCaptureOutput() && !Capture.begin()) {
+    ThrowNapiError(Info, ErrorType::CaptureOutputFailed);
+    return Napi::Value();
+  }
 
   // command mode
   WasmEdge_String WasmFuncName =
       WasmEdge_StringCreateByCString(FuncName.c_str());
   WasmEdge_Value Ret;
-  WasmEdge_Result Res = WasmEdge_VMRunWasmFromFile(
-      VM, BC.getPath().c_str(), WasmFuncName, nullptr, 0, &Ret, 1);
+  WasmEdge_Result Res = WasmEdge_VMRunWasmFromASTModule(
+      VM, AST.get(), WasmFuncName, nullptr, 0, &Ret, 1);
   WasmEdge_StringDelete(WasmFuncName);
 
+  std::vector<uint8_t> Stdout, Stderr;
+  Capture.end(Stdout, Stderr);
+
   if (!WasmEdge_ResultOK(Res)) {
     ThrowNapiError(Info, ErrorType::ExecutionFailed);
     return Napi::Value();
   }
   auto ErrCode = WasmEdge_ResultGetCode(Res);
+  if (!Options.isCaptureOutput() && !MemFS.isMounted()) {
+    FiniVM();
+    return Napi::Number::New(Info.Env(), ErrCode);
+  }
+
+  // Return the captured output and the in-memory files
+  Napi::Object Result = Napi::Object::New(Info.Env());
+  Result.Set("ErrorCode", Napi::Number::New(Info.Env(), ErrCode));
+  if (Options.isCaptureOutput()) {
+    Result.Set("Stdout", toUint8Array(Info.Env(), Stdout));
+    Result.Set("Stderr", toUint8Array(Info.Env(), Stderr));
+  }
+  if (MemFS.isMounted()) {
+    std::map<std::string, WASMEDGE::NAPI::MemFSFiles> Dirs;
+    MemFS.collect(Dirs);
+    Napi::Object Files = Napi::Object::New(Info.Env());
+    for (const auto &[GuestDir, DirFiles] : Dirs) {
+      Napi::Object Dir = Napi::Object::New(Info.Env());
+      for (const auto &[Name, Content] : DirFiles) {
+        Dir.Set(Name, toUint8Array(Info.Env(), Content));
+      }
+      Files.Set(GuestDir, Dir);
+    }
+    Result.Set("Files", Files);
+  }
   FiniVM();
-  return Napi::Number::New(Info.Env(), ErrCode);
+  return Result;
 }
 
 void WasmEdgeAddon::InitReactor(const Napi::CallbackInfo &Info) {
@@ -423,6 +852,9 @@ void WasmEdgeAddon::InitReactor(const Napi::CallbackInfo &Info) {
 }
 
 void WasmEdgeAddon::Run(const Napi::CallbackInfo &Info) {
+  if (IsStreaming(Info)) {
+    return;
+  }
   InitVM(Info);
 
   std::string FuncName = "";
@@ -454,11 +886,64 @@ Napi::Value WasmEdgeAddon::RunCompile(const Napi::CallbackInfo &Info) {
     FileName = Info[0].As<Napi::String>().Utf8Value();
   }
 
+  /// Strips or takes the embedded code of a universal input
+  ScanImports();
+  if (endsWith(FileName, ".wasm")) {
+    return Napi::Value::From(
+        Info.Env(),
+        WASMEDGE::NAPI::compileUniversalTo(BC, Options, FileName));
+  }
   return Napi::Value::From(Info.Env(), CompileBytecodeTo(FileName));
 }
 
+Napi::Value WasmEdgeAddon::RunPrecompile(const Napi::CallbackInfo &Info) {
+  Napi::Object Ret = Napi::Object::New(Info.Env());
+  ScanImports();
+  if (BC.isFile() && endsWith(BC.getPath(), ".so")) {
+    // Already a compiled file, nothing to warm
+    Ret.Set("Path", Napi::String::New(Info.Env(), BC.getPath()));
+    Ret.Set("Cached", Napi::Boolean::New(Info.Env(), true));
+    return Ret;
+  }
+  if (BC.isCompiled()) {
+    Cache.dumpToFile(BC.getData());
+    BC.setPath(Cache.getPath());
+    Ret.Set("Path", Napi::String::New(Info.Env(), BC.getPath()));
+    Ret.Set("Cached", Napi::Boolean::New(Info.Env(), true));
+    return Ret;
+  }
+
+  /// Cached unless this call compiled it, another process may have been
+  /// compiling the same entry meanwhile
+  bool Compiled = false;
+  WASMEDGE::NAPI::Bytecode Origin = BC;
+  if (!Compile(&Compiled)) {
+    napi_throw_error(
+        Info.Env(), "Error",
+        WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::CompileWasmFailed).c_str());
+    return Napi::Value();
+  }
+  if (!Options.isAOTMode()) {
+    BC = std::move(Origin);
+  }
+
+  Ret.Set("Path", Napi::String::New(Info.Env(), Cache.getPath()));
+  Ret.Set("Cached", Napi::Boolean::New(Info.Env(), !Compiled));
+  return Ret;
+}
+
 Napi::Value WasmEdgeAddon::RunIntImpl(const Napi::CallbackInfo &Info,
                                       IntKind IntT) {
+  using Method = WASMEDGE::NAPI::CallRecord::Method;
+  RecordScope Recording(Rec.get(), Options.getRecordSampleRate(), Info,
+                        IntT == IntKind::UInt32   ? Method::UInt
+                        : IntT == IntKind::SInt64 ? Method::Int64
+                        : IntT == IntKind::UInt64 ? Method::UInt64
+                                                  : Method::Int);
+  if (IsStreaming(Info)) {
+    Recording.cancel();
+    return Napi::Value();
+  }
   InitVM(Info);
   std::string FuncName = "";
   if (Info.Length() > 0) {
@@ -468,7 +953,18 @@ Napi::Value WasmEdgeAddon::RunIntImpl(const Napi::CallbackInfo &Info,
   InitWasi(Info, FuncName);
 
   std::vector<WasmEdge_Value> Args;
-  PrepareResource(Info, Args, IntT);
+  bool NativeI64 = (IntT == IntKind::SInt64 || IntT == IntKind::UInt64) &&
+                   usesNativeI64(GetFuncType(FuncName));
+  bool ReturnBigInt = false;
+  if (NativeI64) {
+    ReturnBigInt = PrepareI64Resource(Info, Args, IntT);
+  } else {
+    PrepareResource(Info, Args, IntT);
+  }
+  if (Info.Env().IsExceptionPending()) {
+    FiniVM();
+    return Napi::Value();
+  }
   WasmEdge_String WasmFuncName =
       WasmEdge_StringCreateByCString(FuncName.c_str());
   WasmEdge_Value Ret;
@@ -476,6 +972,22 @@ Napi::Value WasmEdgeAddon::RunIntImpl(const Napi::CallbackInfo &Info,
       WasmEdge_VMExecute(VM, WasmFuncName, Args.data(), Args.size(), &Ret, 1);
   WasmEdge_StringDelete(WasmFuncName);
 
+  if (WasmEdge_ResultOK(Res) && NativeI64) {
+    int64_t V = WasmEdge_ValueGetI64(Ret);
+    FiniVM();
+    /// A Number cannot hold every i64, callers asking with BigInt get one
+    if (ReturnBigInt) {
+      if (IntT == IntKind::SInt64) {
+        return Napi::BigInt::New(Info.Env(), V);
+      }
+      return Napi::BigInt::New(Info.Env(), static_cast<uint64_t>(V));
+    }
+    if (IntT == IntKind::SInt64) {
+      return Napi::Number::New(Info.Env(), static_cast<double>(V));
+    }
+    return Napi::Number::New(Info.Env(),
+                             static_cast<double>(static_cast<uint64_t>(V)));
+  }
   if (WasmEdge_ResultOK(Res)) {
     switch (IntT) {
     case IntKind::SInt32:
@@ -521,23 +1033,45 @@ Napi::Value WasmEdgeAddon::RunUInt64(const Napi::CallbackInfo &Info) {
 }
 
 Napi::Value WasmEdgeAddon::RunString(const Napi::CallbackInfo &Info) {
-  InitVM(Info);
+  RecordScope Recording(Rec.get(), Options.getRecordSampleRate(), Info,
+                        WASMEDGE::NAPI::CallRecord::Method::String);
+  if (IsStreaming(Info)) {
+    Recording.cancel();
+    return Napi::Value();
+  }
   std::string FuncName = "";
   if (Info.Length() > 0) {
     FuncName = Info[0].As<Napi::String>().Utf8Value();
   }
 
+  std::string MemoKey;
+  bool Memoize = Options.isMemoized(FuncName) && makeMemoKey(Info, MemoKey);
+  if (Memoize) {
+    if (const std::vector<uint8_t> *Hit = Memo.find(MemoKey)) {
+      Recording.cancel();
+      LastCall = CallStatistics();
+      return Napi::String::New(Info.Env(),
+                               reinterpret_cast<const char *>(Hit->data()),
+                               Hit->size());
+    }
+  }
+
+  InitVM(Info);
   InitWasi(Info, FuncName);
 
   WasmEdge_Result Res;
   std::vector<WasmEdge_Value> Args;
   uint32_t ResultMemAddr = 8;
-  Args.emplace_back(WasmEdge_ValueGenI32(ResultMemAddr));
+  bool MultiValue = WASMEDGE::NAPI::returnsPtrLen(GetFuncType(FuncName));
+  if (!MultiValue) {
+    Args.emplace_back(WasmEdge_ValueGenI32(ResultMemAddr));
+  }
   PrepareResource(Info, Args);
   WasmEdge_String WasmFuncName =
       WasmEdge_StringCreateByCString(FuncName.c_str());
-  WasmEdge_Value Ret;
-  Res = WasmEdge_VMExecute(VM, WasmFuncName, Args.data(), Args.size(), &Ret, 1);
+  WasmEdge_Value Rets[2];
+  Res = WasmEdge_VMExecute(VM, WasmFuncName, Args.data(), Args.size(), Rets,
+                           MultiValue ? 2 : 1);
   WasmEdge_StringDelete(WasmFuncName);
 
   if (!WasmEdge_ResultOK(Res)) {
@@ -545,77 +1079,650 @@ Napi::Value WasmEdgeAddon::RunString(const Napi::CallbackInfo &Info) {
     return Napi::Value();
   }
 
-  uint8_t ResultMem[8];
-  Res = WasmEdge_MemoryInstanceGetData(MemInst, ResultMem, ResultMemAddr, 8);
   uint32_t ResultDataAddr = 0;
   uint32_t ResultDataLen = 0;
-  if (WasmEdge_ResultOK(Res)) {
-    ResultDataAddr = ResultMem[0] | (ResultMem[1] << 8) | (ResultMem[2] << 16) |
-                     (ResultMem[3] << 24);
-    ResultDataLen = ResultMem[4] | (ResultMem[5] << 8) | (ResultMem[6] << 16) |
-                    (ResultMem[7] << 24);
-  } else {
-    ThrowNapiError(Info, ErrorType::BadMemoryAccess);
-    return Napi::Value();
-  }
-
-  std::vector<uint8_t> ResultData(ResultDataLen);
-  Res = WasmEdge_MemoryInstanceGetData(MemInst, ResultData.data(),
-                                       ResultDataAddr, ResultDataLen);
-  if (WasmEdge_ResultOK(Res)) {
-    ReleaseResource(Info, ResultDataAddr, ResultDataLen);
-  } else {
-    ThrowNapiError(Info, ErrorType::BadMemoryAccess);
+  std::vector<uint8_t> ResultData;
+  if (!GetResultPtrLen(Info, MultiValue ? Rets : nullptr, ResultMemAddr,
+                       ResultDataAddr, ResultDataLen) ||
+      !ReadResultBytes(Info, ResultDataAddr, ResultDataLen, ResultData)) {
     return Napi::Value();
   }
 
   std::string ResultString(ResultData.begin(), ResultData.end());
+  if (Memoize) {
+    Memo.insert(std::move(MemoKey), std::move(ResultData));
+  }
   FiniVM();
   return Napi::String::New(Info.Env(), ResultString);
 }
 
 Napi::Value WasmEdgeAddon::RunUint8Array(const Napi::CallbackInfo &Info) {
-  InitVM(Info);
+  RecordScope Recording(Rec.get(), Options.getRecordSampleRate(), Info,
+                        WASMEDGE::NAPI::CallRecord::Method::Uint8Array);
+  if (IsStreaming(Info)) {
+    Recording.cancel();
+    return Napi::Value();
+  }
   std::string FuncName = "";
   if (Info.Length() > 0) {
     FuncName = Info[0].As<Napi::String>().Utf8Value();
   }
 
+  std::string MemoKey;
+  bool Memoize = Options.isMemoized(FuncName) && makeMemoKey(Info, MemoKey);
+  if (Memoize) {
+    if (const std::vector<uint8_t> *Hit = Memo.find(MemoKey)) {
+      Recording.cancel();
+      LastCall = CallStatistics();
+      return toUint8Array(Info.Env(), *Hit);
+    }
+  }
+
+  InitVM(Info);
   InitWasi(Info, FuncName);
 
-  WasmEdge_Result Res;
-  std::vector<WasmEdge_Value> Args;
-  uint32_t ResultMemAddr = 8;
-  Args.emplace_back(WasmEdge_ValueGenI32(ResultMemAddr));
-  PrepareResource(Info, Args);
-  WasmEdge_String WasmFuncName =
-      WasmEdge_StringCreateByCString(FuncName.c_str());
-  WasmEdge_Value Ret;
-  Res = WasmEdge_VMExecute(VM, WasmFuncName, Args.data(), Args.size(), &Ret, 1);
-  WasmEdge_StringDelete(WasmFuncName);
+  Napi::Value Result = ExecuteUint8Array(Info);
+  if (Memoize && !Info.Env().IsExceptionPending() && Result.IsTypedArray()) {
+    Napi::TypedArray Array = Result.As<Napi::TypedArray>();
+    const uint8_t *Data = static_cast<uint8_t *>(Array.ArrayBuffer().Data());
+    Memo.insert(std::move(MemoKey),
+                std::vector<uint8_t>(Data, Data + Array.ByteLength()));
+  }
+  FiniVM();
+  return Result;
+}
+
+Napi::Value WasmEdgeAddon::RunValue(const Napi::CallbackInfo &Info) {
+  if (IsStreaming(Info)) {
+    return Napi::Value();
+  }
+  std::string FuncName = "";
+  if (Info.Length() > 0) {
+    FuncName = Info[0].As<Napi::String>().Utf8Value();
+  }
+
+  /// Encode before touching the VM, each value becomes one (ptr, len) pair
+  std::vector<std::vector<uint8_t>> Encoded;
+  for (std::size_t I = 1; I < Info.Length(); I++) {
+    Encoded.emplace_back();
+    if (!WASMEDGE::NAPI::encodeMsgPack(Info[I], Encoded.back())) {
+      /// Keep the exception of a throwing getter
+      if (!Info.Env().IsExceptionPending()) {
+        napi_throw_error(
+            Info.Env(), "Error",
+            WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::EncodeMsgPackFailed)
+                .c_str());
+      }
+      return Napi::Value();
+    }
+  }
+
+  InitVM(Info);
+  InitWasi(Info, FuncName);
+  if (Info.Env().IsExceptionPending()) {
+    FiniVM();
+    return Napi::Value();
+  }
+
+  std::vector<WasmEdge_Value> Args;
+  uint32_t ResultMemAddr = 8;
+  bool MultiValue = WASMEDGE::NAPI::returnsPtrLen(GetFuncType(FuncName));
+  if (!MultiValue) {
+    Args.emplace_back(WasmEdge_ValueGenI32(ResultMemAddr));
+  }
+  for (const auto &Bytes : Encoded) {
+    if (!PassBytes(Info.Env(), Bytes.data(), Bytes.size(), Args)) {
+      FiniVM();
+      return Napi::Value();
+    }
+  }
+  WasmEdge_String WasmFuncName =
+      WasmEdge_StringCreateByCString(FuncName.c_str());
+  WasmEdge_Value Rets[2];
+  WasmEdge_Result Res = WasmEdge_VMExecute(
+      VM, WasmFuncName, Args.data(), Args.size(), Rets, MultiValue ? 2 : 1);
+  WasmEdge_StringDelete(WasmFuncName);
+  if (!WasmEdge_ResultOK(Res)) {
+    ThrowNapiError(Info, ErrorType::ExecutionFailed);
+    return Napi::Value();
+  }
+
+  uint32_t ResultDataAddr = 0;
+  uint32_t ResultDataLen = 0;
+  std::vector<uint8_t> ResultData;
+  if (!GetResultPtrLen(Info, MultiValue ? Rets : nullptr, ResultMemAddr,
+                       ResultDataAddr, ResultDataLen) ||
+      !ReadResultBytes(Info, ResultDataAddr, ResultDataLen, ResultData)) {
+    return Napi::Value();
+  }
+  Napi::Value Result = WASMEDGE::NAPI::decodeMsgPack(
+      Info.Env(), ResultData.data(), ResultData.size());
+  if (Result.IsEmpty() && !Info.Env().IsExceptionPending()) {
+    ThrowNapiError(Info, ErrorType::DecodeMsgPackFailed);
+    return Napi::Value();
+  }
+  FiniVM();
+  return Result;
+}
+
+Napi::Value WasmEdgeAddon::ExecuteUint8Array(const Napi::CallbackInfo &Info) {
+  std::string FuncName = "";
+  if (Info.Length() > 0) {
+    FuncName = Info[0].As<Napi::String>().Utf8Value();
+  }
+
+  WasmEdge_Result Res;
+  std::vector<WasmEdge_Value> Args;
+  uint32_t ResultMemAddr = 8;
+  bool MultiValue = WASMEDGE::NAPI::returnsPtrLen(GetFuncType(FuncName));
+  if (!MultiValue) {
+    Args.emplace_back(WasmEdge_ValueGenI32(ResultMemAddr));
+  }
+  PrepareResource(Info, Args);
+  if (Info.Env().IsExceptionPending()) {
+    FiniVM();
+    return Napi::Value();
+  }
+  WasmEdge_String WasmFuncName =
+      WasmEdge_StringCreateByCString(FuncName.c_str());
+  WasmEdge_Value Rets[2];
+  Res = WasmEdge_VMExecute(VM, WasmFuncName, Args.data(), Args.size(), Rets,
+                           MultiValue ? 2 : 1);
+  WasmEdge_StringDelete(WasmFuncName);
 
   if (!WasmEdge_ResultOK(Res)) {
     ThrowNapiError(Info, ErrorType::ExecutionFailed);
     return Napi::Value();
   }
 
-  uint8_t ResultMem[8];
-  Res = WasmEdge_MemoryInstanceGetData(MemInst, ResultMem, ResultMemAddr, 8);
   uint32_t ResultDataAddr = 0;
   uint32_t ResultDataLen = 0;
+  if (!GetResultPtrLen(Info, MultiValue ? Rets : nullptr, ResultMemAddr,
+                       ResultDataAddr, ResultDataLen)) {
+    return Napi::Value();
+  }
+
+  // Copy the result into a JS owned buffer
+  Napi::ArrayBuffer ResultArrayBuffer =
+      Napi::ArrayBuffer::New(Info.Env(), ResultDataLen);
+  Res = WasmEdge_MemoryInstanceGetData(
+      MemInst, static_cast<uint8_t *>(ResultArrayBuffer.Data()),
+      ResultDataAddr, ResultDataLen);
   if (WasmEdge_ResultOK(Res)) {
-    ResultDataAddr = ResultMem[0] | (ResultMem[1] << 8) | (ResultMem[2] << 16) |
-                     (ResultMem[3] << 24);
-    ResultDataLen = ResultMem[4] | (ResultMem[5] << 8) | (ResultMem[6] << 16) |
-                    (ResultMem[7] << 24);
+    ReleaseResource(Info, ResultDataAddr, ResultDataLen);
   } else {
     ThrowNapiError(Info, ErrorType::BadMemoryAccess);
     return Napi::Value();
   }
 
-  std::vector<uint8_t> ResultData(ResultDataLen);
-  Res = WasmEdge_MemoryInstanceGetData(MemInst, ResultData.data(),
-                                       ResultDataAddr, ResultDataLen);
+  return Napi::Uint8Array::New(Info.Env(), ResultDataLen, ResultArrayBuffer, 0,
+                               napi_uint8_array);
+}
+
+Napi::Value WasmEdgeAddon::RunParallel(const Napi::CallbackInfo &Info) {
+  if (Info.Length() < 2 || !Info[0].IsString() || !Info[1].IsArray() ||
+      (Info.Length() > 2 && !Info[2].IsNumber())) {
+    napi_throw_error(
+        Info.Env(), "Error",
+        WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::InvalidParallelInputs).c_str());
+    return Napi::Value();
+  }
+  std::string FuncName = Info[0].As<Napi::String>().Utf8Value();
+  uint32_t Threads = std::thread::hardware_concurrency();
+  if (Info.Length() > 2) {
+    Threads = Info[2].As<Napi::Number>().Uint32Value();
+  }
+
+  /// Copy the inputs, the worker threads cannot touch JS values
+  Napi::Array Array = Info[1].As<Napi::Array>();
+  std::vector<std::vector<uint8_t>> Inputs(Array.Length());
+  for (uint32_t I = 0; I < Array.Length(); I++) {
+    Napi::Value Input = Array.Get(I);
+    if (Input.IsString()) {
+      std::string S = Input.As<Napi::String>().Utf8Value();
+      Inputs[I].assign(S.begin(), S.end());
+    } else if (Input.IsTypedArray() &&
+               Input.As<Napi::TypedArray>().TypedArrayType() ==
+                   napi_uint8_array) {
+      Napi::TypedArray Bytes = Input.As<Napi::TypedArray>();
+      const uint8_t *Data =
+          static_cast<uint8_t *>(Bytes.ArrayBuffer().Data()) +
+          Bytes.ByteOffset();
+      Inputs[I].assign(Data, Data + Bytes.ByteLength());
+    } else {
+      napi_throw_error(Info.Env(), "Error",
+                       WASMEDGE::NAPI::ErrorMsgs
+                           .at(ErrorType::InvalidParallelInputs)
+                           .c_str());
+      return Napi::Value();
+    }
+  }
+
+  /// Compile, parse and validate once on this thread, like Share() does, so
+  /// that each worker thread only instantiates the module.
+  WASMEDGE::NAPI::InstanceConfig Config;
+  if (!PrepareInstanceConfig(Info, Config)) {
+    return Napi::Value();
+  }
+
+  auto *Worker = new WASMEDGE::NAPI::ParallelWorker(
+      Info.Env(), Info.This().As<Napi::Object>(), std::move(Config), FuncName,
+      std::move(Inputs), Threads);
+  Napi::Promise Promise = Worker->getPromise();
+  Worker->Queue();
+  return Promise;
+}
+
+bool WasmEdgeAddon::PrepareInstanceConfig(
+    const Napi::CallbackInfo &Info, WASMEDGE::NAPI::InstanceConfig &Config) {
+  ScanImports();
+  if (Options.isAOTMode() &&
+      !(BC.isFile() && endsWith(BC.getPath(), ".so")) && !BC.isCompiled()) {
+    /// On failure BC is left as wasm and runs in the interpreter
+    Compile();
+  }
+  if (!AST) {
+    /// An open stream keeps its VM, the loader only needs its configuration
+    bool Live = Inited;
+    InitVM(Info, /* SetupOnly */ true);
+    LoadAST(Info);
+    if (Info.Env().IsExceptionPending()) {
+      return false;
+    }
+    if (!Live) {
+      FiniVM();
+    }
+  }
+
+  Config.AST = AST;
+  Config.Threads = Options.isThreadsEnabled();
+  Config.Wasi = IsImported(kWasiModuleName);
+  Config.Process = IsImported(kProcessModuleName);
+  Config.WasiArgs = Options.getWasiCmdArgs();
+  Config.WasiEnvs = Options.getWasiEnvs();
+  Config.WasiDirs = Options.getWasiDirs();
+  Config.AllowedCmds = Options.getAllowedCmds();
+  Config.AllowedCmdsAll = Options.isAllowedCmdsAll();
+  Config.GasLimit = Options.getGasLimit();
+  Config.CostTable = Options.getCostTable();
+  Config.HugePages = Options.isHugePages();
+  Config.PrefaultMemory = Options.isPrefaultMemory();
+  Config.HostMods = HostMods.empty() ? nullptr : &HostMods;
+  Config.Dependencies = Deps;
+  return true;
+}
+
+Napi::Value WasmEdgeAddon::RunAsync(const Napi::CallbackInfo &Info) {
+  using Job = WASMEDGE::NAPI::Scheduler::Job;
+  Napi::Env Env = Info.Env();
+  auto Invalid = [&Env]() {
+    napi_throw_error(
+        Env, "Error",
+        WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::InvalidAsyncCall).c_str());
+    return Napi::Value();
+  };
+  if (Info.Length() < 2 || !Info[0].IsString() ||
+      !(Info[1].IsString() ||
+        (Info[1].IsTypedArray() &&
+         Info[1].As<Napi::TypedArray>().TypedArrayType() ==
+             napi_uint8_array)) ||
+      (Info.Length() > 2 && !Info[2].IsUndefined() && !Info[2].IsObject())) {
+    return Invalid();
+  }
+  auto J = std::make_unique<Job>();
+  J->FuncName = Info[0].As<Napi::String>().Utf8Value();
+  if (Info[1].IsString()) {
+    std::string S = Info[1].As<Napi::String>().Utf8Value();
+    J->Input.assign(S.begin(), S.end());
+  } else {
+    Napi::TypedArray Bytes = Info[1].As<Napi::TypedArray>();
+    const uint8_t *Data = static_cast<uint8_t *>(Bytes.ArrayBuffer().Data()) +
+                          Bytes.ByteOffset();
+    J->Input.assign(Data, Data + Bytes.ByteLength());
+  }
+  if (Info.Length() > 2 && Info[2].IsObject()) {
+    Napi::Object CallOptions = Info[2].As<Napi::Object>();
+    if (CallOptions.Has("Tenant")) {
+      if (!CallOptions.Get("Tenant").IsString()) {
+        return Invalid();
+      }
+      J->Tenant = CallOptions.Get("Tenant").As<Napi::String>().Utf8Value();
+    }
+    if (CallOptions.Has("Priority")) {
+      if (!CallOptions.Get("Priority").IsNumber()) {
+        return Invalid();
+      }
+      int64_t Priority =
+          CallOptions.Get("Priority").As<Napi::Number>().Int64Value();
+      if (Priority < 0 || Priority >= WASMEDGE::NAPI::Scheduler::kPriorities) {
+        return Invalid();
+      }
+      J->Priority = static_cast<uint32_t>(Priority);
+    }
+  }
+
+  if (!Sched || SchedulerStale) {
+    WASMEDGE::NAPI::InstanceConfig Config;
+    if (!PrepareInstanceConfig(Info, Config)) {
+      return Napi::Value();
+    }
+    SchedulerStale = false;
+    if (Sched) {
+      Sched->setConfig(std::move(Config));
+    } else {
+      SchedDone = Napi::ThreadSafeFunction::New(
+          Env, Napi::Function::New(Env, [](const Napi::CallbackInfo &) {}),
+          "WasmEdgeRunAsync", 0, 1);
+      /// Only pending calls keep the event loop alive
+      SchedDone.Unref(Env);
+      WASMEDGE::NAPI::PoolPolicy Pool = Options.getPoolPolicy();
+      if (Pool.MaxThreads == 0) {
+        Pool.MaxThreads = std::thread::hardware_concurrency();
+      }
+      Sched = std::make_unique<WASMEDGE::NAPI::Scheduler>(
+          std::move(Config), Pool, [this](std::unique_ptr<Job> Done) {
+            Job *Raw = Done.release();
+            napi_status Status = SchedDone.NonBlockingCall(
+                Raw, [this](Napi::Env Env, Napi::Function, Job *Raw) {
+                  FinishAsyncCall(Env, std::unique_ptr<Job>(Raw));
+                });
+            if (Status != napi_ok) {
+              delete Raw;
+            }
+          });
+      for (const auto &[Name, Policy] : Options.getTenants()) {
+        Sched->setTenant(Name, Policy);
+      }
+    }
+  }
+
+  J->Id = ++NextCallId;
+  auto Deferred = Napi::Promise::Deferred::New(Env);
+  PendingCalls.emplace(J->Id, Deferred);
+  if (PendingCalls.size() == 1) {
+    SchedDone.Ref(Env);
+  }
+  /// The VM, its host functions and the threads live until the call is done
+  Ref();
+  Sched->submit(std::move(J));
+  return Deferred.Promise();
+}
+
+void WasmEdgeAddon::FinishAsyncCall(
+    Napi::Env Env, std::unique_ptr<WASMEDGE::NAPI::Scheduler::Job> J) {
+  Napi::HandleScope Scope(Env);
+  auto It = PendingCalls.find(J->Id);
+  if (It == PendingCalls.end()) {
+    return;
+  }
+  Napi::Promise::Deferred Deferred = It->second;
+  PendingCalls.erase(It);
+  if (PendingCalls.empty()) {
+    SchedDone.Unref(Env);
+  }
+  if (J->Error.empty()) {
+    Deferred.Resolve(toUint8Array(Env, J->Result));
+  } else {
+    Deferred.Reject(Napi::Error::New(Env, J->Error).Value());
+  }
+  Unref();
+}
+
+Napi::Value WasmEdgeAddon::SetTenant(const Napi::CallbackInfo &Info) {
+  WASMEDGE::NAPI::TenantPolicy Policy;
+  if (Info.Length() < 2 || !Info[0].IsString() ||
+      !WASMEDGE::NAPI::parseTenantPolicy(Policy, Info[1])) {
+    napi_throw_error(
+        Info.Env(), "Error",
+        WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::InvalidTenantPolicy).c_str());
+    return Napi::Value();
+  }
+  std::string Name = Info[0].As<Napi::String>().Utf8Value();
+  Options.setTenant(Name, Policy);
+  if (Sched) {
+    Sched->setTenant(Name, Policy);
+  }
+  return Info.Env().Undefined();
+}
+
+Napi::Value
+WasmEdgeAddon::GetSchedulerStatistics(const Napi::CallbackInfo &Info) {
+  Napi::Env Env = Info.Env();
+  Napi::Object RetStat = Napi::Object::New(Env);
+  Napi::Object Tenants = Napi::Object::New(Env);
+  WASMEDGE::NAPI::Scheduler::PoolStatistics Pool;
+  if (Sched) {
+    Pool = Sched->getPoolStatistics();
+  }
+  RetStat.Set("Threads", Napi::Number::New(Env, Pool.Threads));
+  RetStat.Set("Starting", Napi::Number::New(Env, Pool.Starting));
+  RetStat.Set("Idle", Napi::Number::New(Env, Pool.Idle));
+  RetStat.Set("MemoryBytes", Napi::Number::New(Env, Pool.MemoryBytes));
+  RetStat.Set("ScaleUps", Napi::Number::New(Env, Pool.ScaleUps));
+  RetStat.Set("ScaleDowns", Napi::Number::New(Env, Pool.ScaleDowns));
+  RetStat.Set("Tenants", Tenants);
+  if (!Sched) {
+    return RetStat;
+  }
+  for (const auto &[Name, S] : Sched->getStatistics()) {
+    Napi::Object Tenant = Napi::Object::New(Env);
+    Tenant.Set("Queued", Napi::Number::New(Env, S.Queued));
+    Tenant.Set("Running", Napi::Number::New(Env, S.Running));
+    Tenant.Set("Completed", Napi::Number::New(Env, S.Completed));
+    Tenant.Set("Failed", Napi::Number::New(Env, S.Failed));
+    Tenant.Set("QueueTimeP50", Napi::Number::New(Env, S.QueueTimeP50));
+    Tenant.Set("QueueTimeP99", Napi::Number::New(Env, S.QueueTimeP99));
+    Tenant.Set("QueueTimeMax", Napi::Number::New(Env, S.QueueTimeMax));
+    Tenant.Set("RunTime", Napi::Number::New(Env, S.RunTime));
+    Tenants.Set(Name, Tenant);
+  }
+  return RetStat;
+}
+
+Napi::Value WasmEdgeAddon::SessionRun(const Napi::CallbackInfo &Info) {
+  if (Info.Length() < 3 || !Info[0].IsString() || !Info[1].IsString() ||
+      !(Info[2].IsString() ||
+        (Info[2].IsTypedArray() &&
+         Info[2].As<Napi::TypedArray>().TypedArrayType() ==
+             napi_uint8_array))) {
+    napi_throw_error(
+        Info.Env(), "Error",
+        WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::InvalidSessionArguments)
+            .c_str());
+    return Napi::Value();
+  }
+  std::string Key = Info[0].As<Napi::String>().Utf8Value();
+  std::string FuncName = Info[1].As<Napi::String>().Utf8Value();
+  std::vector<uint8_t> Input;
+  if (Info[2].IsString()) {
+    std::string S = Info[2].As<Napi::String>().Utf8Value();
+    Input.assign(S.begin(), S.end());
+  } else {
+    Napi::TypedArray Bytes = Info[2].As<Napi::TypedArray>();
+    const uint8_t *Data = static_cast<uint8_t *>(Bytes.ArrayBuffer().Data()) +
+                          Bytes.ByteOffset();
+    Input.assign(Data, Data + Bytes.ByteLength());
+  }
+
+  Sessions.expire();
+  WASMEDGE::NAPI::Instance *Inst = Sessions.find(Key);
+  if (Inst == nullptr) {
+    WASMEDGE::NAPI::InstanceConfig Config;
+    if (!PrepareInstanceConfig(Info, Config)) {
+      return Napi::Value();
+    }
+    auto NewInst = std::make_unique<WASMEDGE::NAPI::Instance>();
+    if (auto Err = NewInst->init(Config); !Err.empty()) {
+      napi_throw_error(Info.Env(), "Error", Err.c_str());
+      return Napi::Value();
+    }
+    Inst = Sessions.insert(Key, Config.AST, std::move(NewInst));
+  }
+
+  std::vector<uint8_t> Result;
+  if (auto Err = Inst->callBytes(FuncName, Input.data(),
+                                 static_cast<uint32_t>(Input.size()), Result);
+      !Err.empty()) {
+    /// The guest state cannot be trusted after a trap
+    Sessions.erase(Key);
+    napi_throw_error(Info.Env(), "Error", Err.c_str());
+    return Napi::Value();
+  }
+  return toUint8Array(Info.Env(), Result);
+}
+
+Napi::Value WasmEdgeAddon::SessionEnd(const Napi::CallbackInfo &Info) {
+  if (Info.Length() < 1 || !Info[0].IsString()) {
+    napi_throw_error(
+        Info.Env(), "Error",
+        WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::InvalidSessionArguments)
+            .c_str());
+    return Napi::Value();
+  }
+  return Napi::Boolean::New(
+      Info.Env(), Sessions.erase(Info[0].As<Napi::String>().Utf8Value()));
+}
+
+bool WasmEdgeAddon::IsStreaming(const Napi::CallbackInfo &Info) {
+  if (Streaming) {
+    napi_throw_error(
+        Info.Env(), "Error",
+        WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::StreamInProgress).c_str());
+  }
+  return Streaming;
+}
+
+void WasmEdgeAddon::StreamBegin(const Napi::CallbackInfo &Info) {
+  if (IsStreaming(Info)) {
+    return;
+  }
+  /// Keep one instance alive until StreamEnd(), so that the guest can keep
+  /// its state between the chunks.
+  InitVM(Info);
+  InitWasi(Info, "");
+  if (Info.Env().IsExceptionPending()) {
+    FiniVM();
+    return;
+  }
+  Streaming = true;
+}
+
+Napi::Value WasmEdgeAddon::StreamWrite(const Napi::CallbackInfo &Info) {
+  if (!Streaming) {
+    napi_throw_error(
+        Info.Env(), "Error",
+        WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::StreamNotStarted).c_str());
+    return Napi::Value();
+  }
+  // Errors end the stream through FiniVM()
+  return ExecuteUint8Array(Info);
+}
+
+Napi::Value WasmEdgeAddon::StreamEnd(const Napi::CallbackInfo &Info) {
+  if (!Streaming) {
+    napi_throw_error(
+        Info.Env(), "Error",
+        WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::StreamNotStarted).c_str());
+    return Napi::Value();
+  }
+  // Flush the remaining output when a function name is given
+  Napi::Value Result = Info.Env().Undefined();
+  if (Info.Length() > 0 && Info[0].IsString()) {
+    Result = ExecuteUint8Array(Info);
+  }
+  FiniVM();
+  return Result;
+}
+
+Napi::Value WasmEdgeAddon::RunPipeline(const Napi::CallbackInfo &Info) {
+  if (Info.Length() <= 0 || !Info[0].IsArray() ||
+      Info[0].As<Napi::Array>().Length() == 0) {
+    napi_throw_error(
+        Info.Env(), "Error",
+        WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::InvalidPipelineSteps).c_str());
+    return Napi::Value();
+  }
+  Napi::Array Steps = Info[0].As<Napi::Array>();
+
+  if (IsStreaming(Info)) {
+    return Napi::Value();
+  }
+  InitVM(Info);
+  InitWasi(Info, "");
+  if (Info.Env().IsExceptionPending()) {
+    FiniVM();
+    return Napi::Value();
+  }
+
+  WasmEdge_Result Res;
+  uint32_t ResultMemAddr = 8;
+  uint32_t ResultDataAddr = 0;
+  uint32_t ResultDataLen = 0;
+  for (uint32_t I = 0; I < Steps.Length(); I++) {
+    // Step format: <function_name> or { name, args }
+    Napi::Value Step = Steps[I];
+    std::string FuncName;
+    std::vector<Napi::Value> Values;
+    if (Step.IsString()) {
+      FuncName = Step.As<Napi::String>().Utf8Value();
+    } else if (Step.IsObject() &&
+               Step.As<Napi::Object>().Get("name").IsString()) {
+      FuncName =
+          Step.As<Napi::Object>().Get("name").As<Napi::String>().Utf8Value();
+      Napi::Value StepArgs = Step.As<Napi::Object>().Get("args");
+      if (StepArgs.IsArray()) {
+        for (uint32_t J = 0; J < StepArgs.As<Napi::Array>().Length(); J++) {
+          Values.push_back(StepArgs.As<Napi::Array>()[J]);
+        }
+      }
+    } else {
+      ThrowNapiError(Info, ErrorType::InvalidPipelineSteps);
+      return Napi::Value();
+    }
+
+    std::vector<WasmEdge_Value> Args;
+    bool MultiValue = WASMEDGE::NAPI::returnsPtrLen(GetFuncType(FuncName));
+    if (!MultiValue) {
+      Args.emplace_back(WasmEdge_ValueGenI32(ResultMemAddr));
+    }
+    if (I == 0) {
+      // The first step takes the arguments given from JS
+      PrepareResource(Info, Args);
+    } else {
+      // The following steps take the result of the previous one which is
+      // still in the linear memory. The callee owns and frees it.
+      Args.emplace_back(WasmEdge_ValueGenI32(ResultDataAddr));
+      Args.emplace_back(WasmEdge_ValueGenI32(ResultDataLen));
+    }
+    PrepareResource(Info.Env(), Values, Args, IntKind::Default);
+    if (Info.Env().IsExceptionPending()) {
+      FiniVM();
+      return Napi::Value();
+    }
+
+    WasmEdge_String WasmFuncName =
+        WasmEdge_StringCreateByCString(FuncName.c_str());
+    WasmEdge_Value Rets[2];
+    Res = WasmEdge_VMExecute(VM, WasmFuncName, Args.data(), Args.size(), Rets,
+                             MultiValue ? 2 : 1);
+    WasmEdge_StringDelete(WasmFuncName);
+    if (!WasmEdge_ResultOK(Res)) {
+      ThrowNapiError(Info, ErrorType::ExecutionFailed);
+      return Napi::Value();
+    }
+
+    if (!GetResultPtrLen(Info, MultiValue ? Rets : nullptr, ResultMemAddr,
+                         ResultDataAddr, ResultDataLen)) {
+      return Napi::Value();
+    }
+  }
+
+  // Only the output of the last step is copied out of the linear memory
+  Napi::ArrayBuffer ResultArrayBuffer =
+      Napi::ArrayBuffer::New(Info.Env(), ResultDataLen);
+  Res = WasmEdge_MemoryInstanceGetData(
+      MemInst, static_cast<uint8_t *>(ResultArrayBuffer.Data()),
+      ResultDataAddr, ResultDataLen);
   if (WasmEdge_ResultOK(Res)) {
     ReleaseResource(Info, ResultDataAddr, ResultDataLen);
   } else {
@@ -623,14 +1730,193 @@ Napi::Value WasmEdgeAddon::RunUint8Array(const Napi::CallbackInfo &Info) {
     return Napi::Value();
   }
 
-  Napi::ArrayBuffer ResultArrayBuffer =
-      Napi::ArrayBuffer::New(Info.Env(), &(ResultData[0]), ResultDataLen);
   Napi::Uint8Array ResultTypedArray = Napi::Uint8Array::New(
       Info.Env(), ResultDataLen, ResultArrayBuffer, 0, napi_uint8_array);
   FiniVM();
   return ResultTypedArray;
 }
 
+bool WasmEdgeAddon::LoadSharedModule(const Napi::Object &Handle) {
+  uint64_t Id = static_cast<uint64_t>(
+      Handle.Get(WASMEDGE::NAPI::kSharedModuleString)
+          .As<Napi::Number>()
+          .Int64Value());
+  auto Module = WASMEDGE::NAPI::SharedModuleRegistry::getInstance().find(Id);
+  if (!Module) {
+    return false;
+  }
+  BC = Module->BC;
+  Cache = Module->Cache;
+  AST = Module->AST;
+  ImportModules = Module->ImportModules;
+  ImportsKnown = Module->ImportsKnown;
+  ImportsScanned = true;
+  return true;
+}
+
+Napi::Value WasmEdgeAddon::Share(const Napi::CallbackInfo &Info) {
+  /// Do the expensive work once, so that the other VMs sharing this module
+  /// only have to instantiate it.
+  ScanImports();
+  if (Options.isAOTMode()) {
+    if (BC.isFile() && endsWith(BC.getPath(), ".so")) {
+      // BC is already the compiled filename, do nothing
+    } else if (!BC.isCompiled() && !Compile()) {
+      napi_throw_error(
+          Info.Env(), "Error",
+          WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::CompileWasmFailed).c_str());
+      return Napi::Value();
+    }
+  }
+  if (BC.isCompiled()) {
+    Cache.dumpToFile(BC.getData());
+    BC.setPath(Cache.getPath());
+  }
+
+  // Parse and validate once for all the sharing VMs
+  InitVM(Info, /* SetupOnly */ true);
+  LoadAST(Info);
+  if (Info.Env().IsExceptionPending()) {
+    return Napi::Value();
+  }
+  FiniVM();
+
+  auto Module = std::make_shared<WASMEDGE::NAPI::SharedModule>();
+  Module->BC = BC;
+  Module->Cache = Cache;
+  Module->AST = AST;
+  Module->ImportModules = ImportModules;
+  Module->ImportsKnown = ImportsKnown;
+  auto &Registry = WASMEDGE::NAPI::SharedModuleRegistry::getInstance();
+  uint64_t Id = Registry.add(std::move(Module));
+
+  Napi::Object Handle = Napi::Object::New(Info.Env());
+  Handle.Set(WASMEDGE::NAPI::kSharedModuleString,
+             Napi::Number::New(Info.Env(), static_cast<double>(Id)));
+  return Handle;
+}
+
+Napi::Value WasmEdgeAddon::SwapModule(const Napi::CallbackInfo &Info) {
+  auto Module = std::make_shared<WASMEDGE::NAPI::SharedModule>();
+  if (Info.Length() > 0 && Info[0].IsString()) {
+    Module->BC.setPath(Info[0].As<Napi::String>().Utf8Value());
+  } else if (Info.Length() > 0 && Info[0].IsTypedArray() &&
+             Info[0].As<Napi::TypedArray>().TypedArrayType() ==
+                 napi_uint8_array) {
+    Napi::TypedArray Array = Info[0].As<Napi::TypedArray>();
+    const uint8_t *Data =
+        static_cast<uint8_t *>(Array.ArrayBuffer().Data()) + Array.ByteOffset();
+    Module->BC.setData(std::vector<uint8_t>(Data, Data + Array.ByteLength()));
+  }
+  if (!Module->BC.isFile() && !Module->BC.isValidData()) {
+    napi_throw_error(
+        Info.Env(), "Error",
+        WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::InvalidSwapModule).c_str());
+    return Napi::Value();
+  }
+
+  /// Loading, validating and compiling run in the background. The calls made
+  /// meanwhile keep using the current module.
+  uint64_t Seq = ++SwapsRequested;
+  auto Start = std::chrono::steady_clock::now();
+  auto Apply =
+      [this, Seq, Start](
+          std::shared_ptr<const WASMEDGE::NAPI::SharedModule> Module) {
+        if (Seq < LastAppliedSwap) {
+          return false;
+        }
+        ApplyModule(std::move(Module));
+        LastAppliedSwap = Seq;
+        LastSwapTime = std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - Start)
+                           .count();
+        return true;
+      };
+  auto *Worker = new WASMEDGE::NAPI::SwapModuleWorker(
+      Info.Env(), Info.This().As<Napi::Object>(), Options, std::move(Module),
+      std::move(Apply));
+  Napi::Promise Promise = Worker->getPromise();
+  Worker->Queue();
+  return Promise;
+}
+
+void WasmEdgeAddon::ApplyModule(
+    std::shared_ptr<const WASMEDGE::NAPI::SharedModule> Module) {
+  /// Calls run to completion on the JS thread, so only the instance of an
+  /// open stream is still alive here. It keeps running the old version until
+  /// StreamEnd(). RunParallel() threads keep their own reference to the old
+  /// AST; the old module is released when the last of them is done.
+  BC = Module->BC;
+  Cache = Module->Cache;
+  AST = Module->AST;
+  ImportModules = Module->ImportModules;
+  ImportsKnown = Module->ImportsKnown;
+  ImportsScanned = true;
+  CompileWaitExpired = false;
+  /// Results of the old version must not be returned for the new one
+  Memo.clear();
+  /// Running RunAsync() calls finish with the old module, like RunParallel()
+  SchedulerStale = true;
+  /// A busy session would otherwise never see the new version
+  Sessions.markStale();
+  SwapsApplied++;
+}
+
+Napi::Value WasmEdgeAddon::ReleaseSharedModule(const Napi::CallbackInfo &Info) {
+  if (Info.Length() <= 0 || !isSharedModuleHandle(Info[0])) {
+    napi_throw_error(
+        Info.Env(), "Error",
+        WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::InvalidSharedModule).c_str());
+    return Napi::Value();
+  }
+  uint64_t Id = static_cast<uint64_t>(
+      Info[0]
+          .As<Napi::Object>()
+          .Get(WASMEDGE::NAPI::kSharedModuleString)
+          .As<Napi::Number>()
+          .Int64Value());
+  auto &Registry = WASMEDGE::NAPI::SharedModuleRegistry::getInstance();
+  return Napi::Boolean::New(Info.Env(), Registry.remove(Id));
+}
+
+void WasmEdgeAddon::LoadAST(const Napi::CallbackInfo &Info) {
+  if (AST) {
+    return;
+  }
+
+  if (BC.isCompiled()) {
+    Cache.dumpToFile(BC.getData());
+    BC.setPath(Cache.getPath());
+  }
+
+  WasmEdge_LoaderContext *Loader = WasmEdge_LoaderCreate(Configure);
+  WasmEdge_ASTModuleContext *Module = nullptr;
+  WasmEdge_Result Res;
+  if (BC.isFile()) {
+    Res = WasmEdge_LoaderParseFromFile(Loader, &Module, BC.getPath().c_str());
+  } else {
+    Res = WasmEdge_LoaderParseFromBuffer(Loader, &Module, BC.getData().data(),
+                                         BC.getData().size());
+  }
+  WasmEdge_LoaderDelete(Loader);
+  if (!WasmEdge_ResultOK(Res)) {
+    ThrowNapiError(Info, ErrorType::LoadWasmFailed);
+    return;
+  }
+
+  WasmEdge_ValidatorContext *Validator = WasmEdge_ValidatorCreate(Configure);
+  Res = WasmEdge_ValidatorValidate(Validator, Module);
+  WasmEdge_ValidatorDelete(Validator);
+  if (!WasmEdge_ResultOK(Res)) {
+    WasmEdge_ASTModuleDelete(Module);
+    ThrowNapiError(Info, ErrorType::ValidateWasmFailed);
+    return;
+  }
+
+  AST = std::shared_ptr<WasmEdge_ASTModuleContext>(Module,
+                                                   WasmEdge_ASTModuleDelete);
+}
+
 void WasmEdgeAddon::LoadWasm(const Napi::CallbackInfo &Info) {
   Napi::Env Env = Info.Env();
   Napi::HandleScope Scope(Env);
@@ -640,6 +1926,12 @@ void WasmEdgeAddon::LoadWasm(const Napi::CallbackInfo &Info) {
     BC.setPath(Cache.getPath());
   }
 
+  /// Failing to pin only costs the page faults, the load reports errors
+  if (Options.isPrefaultAOT() && BC.isFile() &&
+      endsWith(BC.getPath(), ".so")) {
+    WASMEDGE::NAPI::pinCompiledModule(BC.getPath(), Options.isHugePages());
+  }
+
   WasmEdge_Result Res;
   if (BC.isFile()) {
     Res = WasmEdge_VMLoadWasmFromFile(VM, BC.getPath().c_str());
@@ -673,6 +1965,8 @@ void WasmEdgeAddon::LoadWasm(const Napi::CallbackInfo &Info) {
   WasmEdge_String MemNames[MemLen];
   WasmEdge_StoreListMemory(Store, MemNames, MemLen);
   MemInst = WasmEdge_StoreFindMemory(Store, MemNames[0]);
+  WASMEDGE::NAPI::adviseLinearMemory(MemInst, Options.isHugePages(),
+                                     Options.isPrefaultMemory());
 }
 
 Napi::Value WasmEdgeAddon::GetStatistics(const Napi::CallbackInfo &Info) {
@@ -681,16 +1975,94 @@ Napi::Value WasmEdgeAddon::GetStatistics(const Napi::CallbackInfo &Info) {
     RetStat.Set("Measure", Napi::Boolean::New(Info.Env(), false));
   } else {
     RetStat.Set("Measure", Napi::Boolean::New(Info.Env(), true));
-    RetStat.Set(
-        "InstructionCount",
-        Napi::Number::New(Info.Env(), WasmEdge_StatisticsGetInstrCount(Stat)));
-    RetStat.Set(
-        "TotalGasCost",
-        Napi::Number::New(Info.Env(), WasmEdge_StatisticsGetTotalCost(Stat)));
+    /// Sums over all the calls, the rate is the one of the last call
+    RetStat.Set("InstructionCount",
+                Napi::Number::New(Info.Env(), TotalCalls.InstrCount));
+    RetStat.Set("TotalGasCost",
+                Napi::Number::New(Info.Env(), TotalCalls.GasCost));
     RetStat.Set("InstructionPerSecond",
+                Napi::Number::New(Info.Env(), LastCall.InstrPerSecond));
+  }
+  if (Options.isMemoizing()) {
+    RetStat.Set("MemoHits", Napi::Number::New(Info.Env(), Memo.getHits()));
+    RetStat.Set("MemoMisses", Napi::Number::New(Info.Env(), Memo.getMisses()));
+    RetStat.Set("MemoEvictions",
+                Napi::Number::New(Info.Env(), Memo.getEvictions()));
+    RetStat.Set("MemoEntries",
+                Napi::Number::New(Info.Env(), Memo.getEntries()));
+    RetStat.Set("MemoBytes", Napi::Number::New(Info.Env(), Memo.getBytes()));
+  }
+  if (Streaming && MemInst != nullptr) {
+    /// Grows for good when buffers of the live instance are never freed
+    RetStat.Set("MemoryPages",
                 Napi::Number::New(Info.Env(),
-                                  WasmEdge_StatisticsGetInstrPerSecond(Stat)));
+                                  WasmEdge_MemoryInstanceGetPageSize(MemInst)));
+  }
+  Sessions.expire();
+  if (Sessions.getHits() + Sessions.getMisses() > 0) {
+    RetStat.Set("Sessions",
+                Napi::Number::New(Info.Env(), Sessions.getSessions()));
+    RetStat.Set("SessionHits",
+                Napi::Number::New(Info.Env(), Sessions.getHits()));
+    RetStat.Set("SessionMisses",
+                Napi::Number::New(Info.Env(), Sessions.getMisses()));
+    RetStat.Set("SessionEvictions",
+                Napi::Number::New(Info.Env(), Sessions.getEvictions()));
+    RetStat.Set("SessionExpirations",
+                Napi::Number::New(Info.Env(), Sessions.getExpirations()));
+    RetStat.Set("SessionMemoryPages",
+                Napi::Number::New(Info.Env(), Sessions.getMemoryPages()));
+  }
+  if (Rec) {
+    /// Counts of the log, which is shared by the VMs recording into it
+    RetStat.Set("Recorded", Napi::Number::New(Info.Env(), Rec->getRecorded()));
+    RetStat.Set("RecordDropped",
+                Napi::Number::New(Info.Env(), Rec->getDropped()));
   }
+  if (SwapsApplied > 0) {
+    RetStat.Set("ModuleSwaps", Napi::Number::New(Info.Env(), SwapsApplied));
+    RetStat.Set("LastSwapTime", Napi::Number::New(Info.Env(), LastSwapTime));
+  }
+
+  return RetStat;
+}
 
+Napi::Value WasmEdgeAddon::GetCallStatistics(const Napi::CallbackInfo &Info) {
+  Napi::Env Env = Info.Env();
+  Napi::Object RetStat = Napi::Object::New(Env);
+  RetStat.Set("InstructionCount", Napi::Number::New(Env, LastCall.InstrCount));
+  RetStat.Set("TotalGasCost", Napi::Number::New(Env, LastCall.GasCost));
+  RetStat.Set("InstructionPerSecond",
+              Napi::Number::New(Env, LastCall.InstrPerSecond));
+  RetStat.Set("WallTime", Napi::Number::New(Env, LastCall.WallTime));
+  RetStat.Set("CpuTime", Napi::Number::New(Env, LastCall.CpuTime));
+  RetStat.Set("GasLimitExceeded",
+              Napi::Boolean::New(Env, LastCall.GasLimitExceeded));
   return RetStat;
 }
+
+Napi::Value WasmEdgeAddon::SetGasLimit(const Napi::CallbackInfo &Info) {
+  if (Info.Length() < 1 || !Info[0].IsNumber() ||
+      Info[0].As<Napi::Number>().Int64Value() < 0) {
+    napi_throw_error(
+        Info.Env(), "Error",
+        WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::InvalidGasLimit).c_str());
+    return Napi::Value();
+  }
+  /// AOT code only counts gas when compiled with the counters, which cannot
+  /// be added once the module is loaded
+  if (!Options.isMeasuring()) {
+    napi_throw_error(
+        Info.Env(), "Error",
+        WASMEDGE::NAPI::ErrorMsgs.at(ErrorType::GasMeteringDisabled).c_str());
+    return Napi::Value();
+  }
+  /// Applies from the next call, a running stream keeps its budget
+  uint64_t Limit =
+      static_cast<uint64_t>(Info[0].As<Napi::Number>().Int64Value());
+  Options.setGasLimit(Limit);
+  Sessions.setGasLimit(Limit);
+  /// The RunAsync() threads take the new configuration with their next call
+  SchedulerStale = true;
+  return Info.Env().Undefined();
+}
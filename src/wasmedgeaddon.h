@@ -3,11 +3,29 @@
 
 #include "bytecode.h"
 #include "cache.h"
+#include "compiler.h"
+#include "dependency.h"
 #include "errors.h"
+#include "hostfunction.h"
+#include "instance.h"
+#include "memfs.h"
+#include "memocache.h"
+#include "msgpack.h"
 #include "options.h"
+#include "parallel.h"
+#include "prefault.h"
+#include "recorder.h"
+#include "scheduler.h"
+#include "session.h"
+#include "sharedmodule.h"
+#include "swapmodule.h"
+#include "universal.h"
 #include "utils.h"
 
+#include <chrono>
+#include <memory>
 #include <napi.h>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -26,40 +44,123 @@ public:
       WasmEdge_VMDelete(VM);
       VM = nullptr;
     }
+    /// Pending RunAsync() calls keep the VM alive, so the threads are idle
+    Sched.reset();
+    if (SchedDone) {
+      SchedDone.Release();
+    }
   };
 
   enum class IntKind { Default, SInt32, UInt32, SInt64, UInt64 };
 
 private:
   using ErrorType = WASMEDGE::NAPI::ErrorType;
-  static Napi::FunctionReference Constructor;
   WasmEdge_ConfigureContext *Configure;
   WasmEdge_StoreContext *Store;
   WasmEdge_VMContext *VM;
   WasmEdge_MemoryInstanceContext *MemInst;
-  WasmEdge_StatisticsContext *Stat;
   WasmEdge_ImportObjectContext *WasiMod;
   WASMEDGE::NAPI::Bytecode BC;
   WASMEDGE::NAPI::Options Options;
   WASMEDGE::NAPI::Cache Cache;
+  WASMEDGE::NAPI::HostModules HostMods;
+  WASMEDGE::NAPI::MemoryFS MemFS;
+  WASMEDGE::NAPI::MemoCache Memo;
+  WASMEDGE::NAPI::SessionPool Sessions;
+  /// RunAsync() threads, started by the first call
+  std::unique_ptr<WASMEDGE::NAPI::Scheduler> Sched;
+  /// Settles the promises of RunAsync() on the JS thread
+  Napi::ThreadSafeFunction SchedDone;
+  std::unordered_map<uint64_t, Napi::Promise::Deferred> PendingCalls;
+  uint64_t NextCallId = 0;
+  /// Set by SwapModule(), the next RunAsync() updates the scheduler
+  bool SchedulerStale = false;
+  /// Parsed and validated module, shared with other VMs by Share()
+  std::shared_ptr<WasmEdge_ASTModuleContext> AST;
   bool Inited;
+  /// The VM only loads the module, FiniVM() does not record it as a call
+  bool SetupOnly = false;
+  bool Streaming;
+  /// Set when waiting for another compiler of the same module timed out
+  bool CompileWaitExpired;
+  /// Module names in the import section, only valid when ImportsKnown
+  std::set<std::string> ImportModules;
+  bool ImportsKnown;
+  /// The scan is not retried when it failed, so that it reads the file once
+  bool ImportsScanned = false;
+  /// Modules of the Dependencies option and the modules they import
+  std::vector<WASMEDGE::NAPI::Dependency> Deps;
+  std::set<std::string> DepImports;
+  bool DepImportsKnown = true;
+  /// Log of the Record option, nullptr when not recording
+  std::shared_ptr<WASMEDGE::NAPI::Recorder> Rec;
+  /// Cost of the last call, and the sums over all the calls
+  struct CallStatistics {
+    uint64_t InstrCount = 0;
+    uint64_t GasCost = 0;
+    double InstrPerSecond = 0;
+    double WallTime = 0;
+    double CpuTime = 0;
+    bool GasLimitExceeded = false;
+  };
+  CallStatistics LastCall, TotalCalls;
+  std::chrono::steady_clock::time_point CallStart;
+  double CallCpuStart = 0;
+  /// SwapModule() calls, numbered so that a slow swap never replaces the
+  /// module of a more recent one
+  uint64_t SwapsRequested = 0;
+  uint64_t SwapsApplied = 0;
+  uint64_t LastAppliedSwap = 0;
+  double LastSwapTime = 0;
 
   /// Setup related functions
-  void InitVM(const Napi::CallbackInfo &Info);
+  void InitVM(const Napi::CallbackInfo &Info, bool SetupOnly = false);
   void FiniVM();
+  void ScanImports();
+  bool IsImported(const std::string &ModuleName) const;
   void InitWasi(const Napi::CallbackInfo &Info, const std::string &FuncName);
+  void InitWasi(const Napi::CallbackInfo &Info, const std::string &FuncName,
+                const std::vector<std::string> &Args,
+                const std::vector<std::string> &Envs);
+  void InitWasiModule(const std::vector<std::string> &Args,
+                      const std::vector<std::string> &Envs);
   void LoadWasm(const Napi::CallbackInfo &Info);
+  void LoadAST(const Napi::CallbackInfo &Info);
   /// WasmBindgen related functions
+  void PrepareResource(Napi::Env Env, const std::vector<Napi::Value> &Values,
+                       std::vector<WasmEdge_Value> &Args, IntKind IntT);
   void PrepareResource(const Napi::CallbackInfo &Info,
                        std::vector<WasmEdge_Value> &Args, IntKind IntT);
   void PrepareResource(const Napi::CallbackInfo &Info,
                        std::vector<WasmEdge_Value> &Args);
   void ReleaseResource(const Napi::CallbackInfo &Info, const uint32_t Offset,
                        const uint32_t Size);
+  /// Copy bytes into a __wbindgen_malloc buffer and append (ptr, len) to Args
+  bool PassBytes(Napi::Env Env, const uint8_t *Data, uint32_t Size,
+                 std::vector<WasmEdge_Value> &Args);
+  /// Pass i64 arguments as they are to exports using native i64. Return
+  /// whether any of them is a BigInt, the result is then one too.
+  bool PrepareI64Resource(const Napi::CallbackInfo &Info,
+                          std::vector<WasmEdge_Value> &Args, IntKind IntT);
+  /// Export calling conventions
+  const WasmEdge_FunctionTypeContext *GetFuncType(const std::string &FuncName);
+  /// (ptr, len) of a result, from the multi-value Rets when given, otherwise
+  /// from the return pointer at ResultMemAddr
+  bool GetResultPtrLen(const Napi::CallbackInfo &Info,
+                       const WasmEdge_Value *Rets, uint32_t ResultMemAddr,
+                       uint32_t &Addr, uint32_t &Len);
+  /// Copy and free a result buffer
+  bool ReadResultBytes(const Napi::CallbackInfo &Info, uint32_t ResultDataAddr,
+                       uint32_t ResultDataLen, std::vector<uint8_t> &Result);
   /// Run functions
   void Run(const Napi::CallbackInfo &Info);
   Napi::Value RunStart(const Napi::CallbackInfo &Info);
+  Napi::Value RunStartWith(const Napi::CallbackInfo &Info);
+  Napi::Value RunCommand(const Napi::CallbackInfo &Info,
+                         const std::vector<std::string> &Args,
+                         const std::vector<std::string> &Envs);
   Napi::Value RunCompile(const Napi::CallbackInfo &Info);
+  Napi::Value RunPrecompile(const Napi::CallbackInfo &Info);
   Napi::Value RunIntImpl(const Napi::CallbackInfo &Info, IntKind IntT);
   Napi::Value RunInt(const Napi::CallbackInfo &Info);
   Napi::Value RunUInt(const Napi::CallbackInfo &Info);
@@ -67,10 +168,40 @@ private:
   Napi::Value RunUInt64(const Napi::CallbackInfo &Info);
   Napi::Value RunString(const Napi::CallbackInfo &Info);
   Napi::Value RunUint8Array(const Napi::CallbackInfo &Info);
+  Napi::Value RunValue(const Napi::CallbackInfo &Info);
+  Napi::Value RunPipeline(const Napi::CallbackInfo &Info);
+  Napi::Value ExecuteUint8Array(const Napi::CallbackInfo &Info);
+  Napi::Value RunParallel(const Napi::CallbackInfo &Info);
+  /// Parse and validate once, for instances which live outside of the VM
+  bool PrepareInstanceConfig(const Napi::CallbackInfo &Info,
+                             WASMEDGE::NAPI::InstanceConfig &Config);
+  /// Scheduled functions
+  Napi::Value RunAsync(const Napi::CallbackInfo &Info);
+  void FinishAsyncCall(Napi::Env Env,
+                       std::unique_ptr<WASMEDGE::NAPI::Scheduler::Job> J);
+  Napi::Value SetTenant(const Napi::CallbackInfo &Info);
+  Napi::Value GetSchedulerStatistics(const Napi::CallbackInfo &Info);
+  /// Session functions
+  Napi::Value SessionRun(const Napi::CallbackInfo &Info);
+  Napi::Value SessionEnd(const Napi::CallbackInfo &Info);
+  /// Streaming functions
+  bool IsStreaming(const Napi::CallbackInfo &Info);
+  void StreamBegin(const Napi::CallbackInfo &Info);
+  Napi::Value StreamWrite(const Napi::CallbackInfo &Info);
+  Napi::Value StreamEnd(const Napi::CallbackInfo &Info);
+  /// Shared module functions
+  Napi::Value Share(const Napi::CallbackInfo &Info);
+  static Napi::Value ReleaseSharedModule(const Napi::CallbackInfo &Info);
+  bool LoadSharedModule(const Napi::Object &Handle);
+  /// Hot module swap
+  Napi::Value SwapModule(const Napi::CallbackInfo &Info);
+  void ApplyModule(std::shared_ptr<const WASMEDGE::NAPI::SharedModule> Module);
   /// Statistics
   Napi::Value GetStatistics(const Napi::CallbackInfo &Info);
+  Napi::Value GetCallStatistics(const Napi::CallbackInfo &Info);
+  Napi::Value SetGasLimit(const Napi::CallbackInfo &Info);
   /// AoT functions
-  bool Compile();
+  bool Compile(bool *Compiled = nullptr);
   bool CompileBytecodeTo(const std::string &Path);
   void InitReactor(const Napi::CallbackInfo &Info);
   /// Error handling functions
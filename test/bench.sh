@@ -0,0 +1,21 @@
+#!/usr/bin/env bash
+set -xe
+rustwasmc build
+cd pkg
+npm install ../..
+cd -
+cd bench
+rustwasmc build
+cargo build --release --target wasm32-wasi --bin bench_start
+cd large
+rustwasmc build
+cd ../..
+node bench/run-paths.js --out run-paths.json
+node bench/aot-opt-levels.js
+node bench/prefault.js --out prefault.json
+rustwasmc clean
+cd bench
+rustwasmc clean
+cd large
+rustwasmc clean
+cd ../..
@@ -0,0 +1,61 @@
+// Compare the AOT optimization levels on the test modules: compile time,
+// first call latency and warm call throughput.
+//
+// Usage: node bench/aot-opt-levels.js [iterations]
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const ssvm = require('../..');
+
+const iterations = parseInt(process.argv[2] || '2000');
+const inputName = path.join(__dirname, '..', 'pkg', 'integers_lib_bg.wasm');
+const levels = [ 'O0', 'O1', 'O2', 'O3', 'Os', 'Oz' ];
+const targets = [ false, true ]; // native, generic
+
+function nowMs() { return Number(process.hrtime.bigint()) / 1e6; }
+
+let results = [];
+for (let generic of targets) {
+  for (let level of levels) {
+    let options = {
+      EnableAOT : true,
+      AOTOptimizationLevel : level,
+      AOTGenericBinary : generic,
+    };
+    let aotName = path.join(os.tmpdir(),
+                            `wasmedge.bench.${level}.${generic ? 'generic' : 'native'}.so`);
+
+    let start = nowMs();
+    assert(new ssvm.VM(inputName, options).Compile(aotName));
+    let compileMs = nowMs() - start;
+
+    let vm = new ssvm.VM(aotName, options);
+    start = nowMs();
+    vm.RunInt('lcm_s32', 123, 1011);
+    let firstCallMs = nowMs() - start;
+
+    start = nowMs();
+    for (let i = 0; i < iterations; i++) {
+      vm.RunInt64('lcm_s64', 2147483647, 2);
+    }
+    let warmMs = nowMs() - start;
+
+    results.push({
+      level : level,
+      target : generic ? 'generic' : 'native',
+      compileMs : compileMs,
+      soBytes : fs.statSync(aotName).size,
+      firstCallMs : firstCallMs,
+      callsPerSecond : iterations / (warmMs / 1000),
+    });
+    fs.unlinkSync(aotName);
+  }
+}
+
+function assert(ok) {
+  if (!ok) {
+    throw new Error('AOT compilation failed');
+  }
+}
+
+console.log(JSON.stringify({benchmark : 'aot-opt-levels', results}, null, 2));
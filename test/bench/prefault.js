@@ -0,0 +1,182 @@
+// Huge pages and prefaulting on a large module: first call and warm latency
+// and the minor page faults per call, with and without HugePages,
+// PrefaultAOT and PrefaultMemory.
+//
+// Usage: node bench/prefault.js [--quick] [--out report.json]
+//
+// The workload is walk() of rs/bench_large.rs, built by bench.sh: random
+// writes into a 32 MiB table, through code spread over the AOT module.
+// "per-call" is RunUint8Array, which instantiates the module on every call.
+// "stream" is one instance kept by StreamBegin(), where "first" is the first
+// StreamWrite() and "setup" is StreamBegin() itself, which then includes the
+// prefaulting. Huge pages need transparent huge pages set to "madvise" or
+// "always" in /sys/kernel/mm/transparent_hugepage/enabled.
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const ssvm = require('../..');
+
+const args = parseArgs(process.argv.slice(2));
+const largeName =
+    path.join(__dirname, 'large', 'pkg', 'bench_large_bg.wasm');
+
+const samples = args.quick ? 5 : 20;
+const warmCalls = args.quick ? 50 : 500;
+const inputBytes = 4096;
+
+const modes = [
+  {name : 'baseline', options : {}},
+  {name : 'huge-pages', options : {HugePages : true}},
+  {name : 'prefault-aot', options : {PrefaultAOT : true}},
+  {name : 'prefault-memory', options : {PrefaultMemory : true}},
+  {
+    name : 'all',
+    options : {HugePages : true, PrefaultAOT : true, PrefaultMemory : true},
+  },
+];
+
+function parseArgs(argv) {
+  let args = {quick : false, out : ''};
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i] === '--quick') {
+      args.quick = true;
+    } else if (argv[i] === '--out') {
+      args.out = argv[++i];
+    } else {
+      console.error('Usage: node bench/prefault.js [--quick] [--out file]');
+      process.exit(2);
+    }
+  }
+  return args;
+}
+
+function payload(size, seed) {
+  let bytes = new Uint8Array(size);
+  let x = 2463534242 ^ seed;
+  for (let i = 0; i < size; i++) {
+    x ^= x << 13;
+    x ^= x >>> 17;
+    x ^= x << 5;
+    bytes[i] = x & 0xff;
+  }
+  return bytes;
+}
+
+function nowUs() { return Number(process.hrtime.bigint()) / 1e3; }
+
+function faults() { return process.resourceUsage().minorPageFault; }
+
+// Latency in µs and minor page faults of one call
+function timed(call) {
+  let f = faults();
+  let start = nowUs();
+  let r = call();
+  let us = nowUs() - start;
+  if (r !== undefined && r.length !== 4) {
+    throw new Error('walk() returned a wrong result');
+  }
+  return {us : us, faults : faults() - f};
+}
+
+function summarize(list) {
+  let us = Float64Array.from(list.map((s) => s.us)).sort();
+  let at = (p) => us[Math.min(us.length - 1, Math.floor(p * us.length))];
+  return {
+    calls : list.length,
+    p50Us : at(0.5),
+    p99Us : at(0.99),
+    faultsPerCall : list.reduce((a, s) => a + s.faults, 0) / list.length,
+  };
+}
+
+function perCall(mode, inputs) {
+  let options = Object.assign({EnableAOT : true}, mode.options);
+  let first = [];
+  for (let i = 0; i < samples; i++) {
+    let vm = new ssvm.VM(largeName, options);
+    first.push(timed(() => vm.RunUint8Array('walk', inputs[i])));
+  }
+  let vm = new ssvm.VM(largeName, options);
+  let warm = [];
+  for (let i = 0; i < warmCalls; i++) {
+    warm.push(timed(() => vm.RunUint8Array('walk', inputs[i])));
+  }
+  return {first : summarize(first), warm : summarize(warm)};
+}
+
+function stream(mode, inputs) {
+  let options = Object.assign({EnableAOT : true}, mode.options);
+  let setup = [], first = [], warm = [];
+  for (let i = 0; i < samples; i++) {
+    let vm = new ssvm.VM(largeName, options);
+    setup.push(timed(() => vm.StreamBegin()));
+    first.push(timed(() => vm.StreamWrite('walk', inputs[i])));
+    for (let j = 0; j < warmCalls / samples; j++) {
+      warm.push(timed(() => vm.StreamWrite('walk', inputs[j])));
+    }
+    vm.StreamEnd();
+  }
+  return {
+    setup : summarize(setup),
+    first : summarize(first),
+    warm : summarize(warm),
+  };
+}
+
+function main() {
+  let cacheDir = fs.mkdtempSync(path.join(os.tmpdir(), 'wasmedge-bench-'));
+  process.env.WASMEDGE_CACHE_DIR = cacheDir;
+
+  let start = nowUs();
+  let res = new ssvm.VM(largeName, {EnableAOT : true}).Precompile();
+  let compile = {
+    compileMs : (nowUs() - start) / 1e3,
+    wasmBytes : fs.statSync(largeName).size,
+    soBytes : fs.statSync(res.Path).size,
+  };
+
+  let inputs = Array.from({length : Math.max(samples, warmCalls)},
+                          (_, i) => payload(inputBytes, i));
+  let results = [];
+  for (let mode of modes) {
+    results.push({
+      mode : mode.name,
+      options : mode.options,
+      perCall : perCall(mode, inputs),
+      stream : stream(mode, inputs),
+    });
+  }
+  for (let name of fs.readdirSync(cacheDir)) {
+    fs.unlinkSync(path.join(cacheDir, name));
+  }
+  fs.rmdirSync(cacheDir);
+
+  let thp = 'unknown';
+  try {
+    thp = fs.readFileSync('/sys/kernel/mm/transparent_hugepage/enabled',
+                          'utf8')
+              .trim();
+  } catch (e) {
+    // Not Linux or no THP support
+  }
+  let report = JSON.stringify({
+    benchmark : 'prefault',
+    date : new Date().toISOString(),
+    addon : require('../../package.json').version,
+    node : process.version,
+    platform : `${os.platform()} ${os.release()} ${os.arch()}`,
+    cpu : os.cpus()[0].model,
+    transparentHugePages : thp,
+    quick : args.quick,
+    inputBytes : inputBytes,
+    compile : compile,
+    results : results,
+  }, null, 2);
+  if (args.out) {
+    fs.writeFileSync(args.out, report + '\n');
+  } else {
+    console.log(report);
+  }
+}
+
+main();
@@ -0,0 +1,247 @@
+// Per-call latency percentiles and throughput of every Run* path, in the
+// interpreter and AOT, for cold and warm VMs and payloads from bytes to
+// megabytes. The report is JSON so that releases can be compared.
+//
+// Usage: node bench/run-paths.js [--quick] [--out report.json]
+//
+// The workloads are built from rs/bench_lib.rs and rs/bench_start.rs by
+// bench.sh. The metered modes show the overhead of the gas accounting
+// (EnableMeasurement, GasLimit, GetCallStatistics) against plain AOT code.
+// "cold" is a new VM and its first call, with the AOT cache already filled;
+// the compilation time is reported separately. "warm" is a loop of calls on
+// the same VM after a few warmup calls.
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const ssvm = require('../..');
+
+const args = parseArgs(process.argv.slice(2));
+const libName = path.join(__dirname, 'pkg', 'bench_lib_bg.wasm');
+const startName = path.join(__dirname, 'target', 'wasm32-wasi', 'release',
+                            'bench_start.wasm');
+
+const warmupCalls = args.quick ? 10 : 100;
+const maxCalls = args.quick ? 200 : 5000;
+// Bytes passed per warm case, so that megabyte payloads stay affordable
+const maxBytes = (args.quick ? 64 : 512) * 1024 * 1024;
+const coldSamples = args.quick ? 3 : 10;
+const payloadSizes = [ 16, 1024, 64 * 1024, 1024 * 1024, 4 * 1024 * 1024 ];
+
+const modes = [
+  {name : 'interpreter', options : {}},
+  {name : 'aot', options : {EnableAOT : true}},
+  {
+    name : 'aot-measure',
+    options : {EnableAOT : true, EnableMeasurement : true},
+  },
+  {
+    name : 'aot-gas-limit',
+    options : {EnableAOT : true, GasLimit : 1e15},
+    callStatistics : true,
+  },
+];
+
+const cases = [
+  {method : 'Run', func : 'noop', call : (vm) => vm.Run('noop')},
+  {
+    method : 'RunInt',
+    func : 'add_i32',
+    call : (vm) => vm.RunInt('add_i32', 40, 2),
+    check : (r) => r === 42,
+  },
+  {
+    method : 'RunInt64',
+    func : 'add_i64',
+    call : (vm) => vm.RunInt64('add_i64', 40, 2),
+    check : (r) => Number(r) === 42,
+  },
+  {
+    method : 'RunString',
+    func : 'echo_string',
+    input : (size) => stringPayload(size),
+    call : (vm, s) => vm.RunString('echo_string', s),
+    check : (r, s) => r.length === s.length,
+  },
+  {
+    method : 'RunUint8Array',
+    func : 'echo_bytes',
+    input : (size) => bytesPayload(size),
+    call : (vm, b) => vm.RunUint8Array('echo_bytes', b),
+    check : (r, b) => r.length === b.length,
+  },
+  {
+    method : 'RunUint8Array',
+    func : 'fnv1a',
+    input : (size) => bytesPayload(size),
+    call : (vm, b) => vm.RunUint8Array('fnv1a', b),
+    check : (r) => r.length === 8,
+  },
+  {
+    method : 'Start',
+    func : '_start',
+    file : startName,
+    options : {EnableWasiStartFunction : true},
+    call : (vm) => vm.Start(),
+    check : (r) => r === 0,
+  },
+];
+
+function parseArgs(argv) {
+  let args = {quick : false, out : ''};
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i] === '--quick') {
+      args.quick = true;
+    } else if (argv[i] === '--out') {
+      args.out = argv[++i];
+    } else {
+      console.error('Usage: node bench/run-paths.js [--quick] [--out file]');
+      process.exit(2);
+    }
+  }
+  return args;
+}
+
+// Same pseudo-random payload on every run
+function bytesPayload(size) {
+  let bytes = new Uint8Array(size);
+  let x = 2463534242;
+  for (let i = 0; i < size; i++) {
+    x ^= x << 13;
+    x ^= x >>> 17;
+    x ^= x << 5;
+    bytes[i] = x & 0xff;
+  }
+  return bytes;
+}
+
+function stringPayload(size) {
+  return Buffer.from(bytesPayload(size).map((b) => 97 + (b % 26)))
+      .toString('latin1');
+}
+
+function nowUs() { return Number(process.hrtime.bigint()) / 1e3; }
+
+function summarize(samples) {
+  let sorted = Float64Array.from(samples).sort();
+  let at = (p) => sorted[Math.min(sorted.length - 1,
+                                  Math.floor(p * sorted.length))];
+  let total = sorted.reduce((a, b) => a + b, 0);
+  return {
+    min : sorted[0],
+    p50 : at(0.5),
+    p90 : at(0.9),
+    p99 : at(0.99),
+    max : sorted[sorted.length - 1],
+    mean : total / sorted.length,
+    totalUs : total,
+  };
+}
+
+function measure(c, mode, input, size) {
+  let file = c.file || libName;
+  let options = Object.assign({}, mode.options, c.options || {});
+  let run = (vm) => {
+    let r = c.call(vm, input);
+    if (c.check && !c.check(r, input)) {
+      throw new Error(`${c.method}(${c.func}) returned a wrong result`);
+    }
+    if (mode.callStatistics) {
+      vm.GetCallStatistics();
+    }
+  };
+  let base = {
+    method : c.method,
+    func : c.func,
+    mode : mode.name,
+    payloadBytes : size,
+  };
+
+  let cold = [];
+  for (let i = 0; i < coldSamples; i++) {
+    let start = nowUs();
+    run(new ssvm.VM(file, options));
+    cold.push(nowUs() - start);
+  }
+
+  let vm = new ssvm.VM(file, options);
+  for (let i = 0; i < warmupCalls; i++) {
+    run(vm);
+  }
+  let calls = maxCalls;
+  if (size) {
+    calls = Math.max(10, Math.min(maxCalls, Math.floor(maxBytes / size)));
+  }
+  let warm = [];
+  for (let i = 0; i < calls; i++) {
+    let start = nowUs();
+    run(vm);
+    warm.push(nowUs() - start);
+  }
+
+  return [ cold, warm ].map((samples, i) => {
+    let latencyUs = summarize(samples);
+    let result = Object.assign({phase : i === 0 ? 'cold' : 'warm'}, base, {
+      calls : samples.length,
+      latencyUs : latencyUs,
+      callsPerSecond : samples.length / (latencyUs.totalUs / 1e6),
+    });
+    if (size) {
+      result.megabytesPerSecond =
+          (size * samples.length) / latencyUs.totalUs;
+    }
+    delete latencyUs.totalUs;
+    return result;
+  });
+}
+
+function main() {
+  // Start from an empty AOT cache, so that the compile times are real
+  let cacheDir = fs.mkdtempSync(path.join(os.tmpdir(), 'wasmedge-bench-'));
+  process.env.WASMEDGE_CACHE_DIR = cacheDir;
+
+  let compile = [];
+  for (let file of [ libName, startName ]) {
+    let start = nowUs();
+    let res = new ssvm.VM(file, {EnableAOT : true}).Precompile();
+    compile.push({
+      module : path.basename(file),
+      compileMs : (nowUs() - start) / 1e3,
+      soBytes : fs.statSync(res.Path).size,
+    });
+  }
+
+  let results = [];
+  for (let mode of modes) {
+    for (let c of cases) {
+      let sizes = c.input ? payloadSizes : [ 0 ];
+      for (let size of sizes) {
+        let input = c.input ? c.input(size) : undefined;
+        results.push(...measure(c, mode, input, size));
+      }
+    }
+  }
+  for (let name of fs.readdirSync(cacheDir)) {
+    fs.unlinkSync(path.join(cacheDir, name));
+  }
+  fs.rmdirSync(cacheDir);
+
+  let report = JSON.stringify({
+    benchmark : 'run-paths',
+    date : new Date().toISOString(),
+    addon : require('../../package.json').version,
+    node : process.version,
+    platform : `${os.platform()} ${os.release()} ${os.arch()}`,
+    cpu : os.cpus()[0].model,
+    cpus : os.cpus().length,
+    quick : args.quick,
+    compile : compile,
+    results : results,
+  }, null, 2);
+  if (args.out) {
+    fs.writeFileSync(args.out, report + '\n');
+  } else {
+    console.log(report);
+  }
+}
+
+main();
@@ -0,0 +1,386 @@
+// Concurrency scaling and soak test. Many VMs are driven from worker threads
+// to report the throughput against the number of threads, the latency
+// percentiles, and the RSS and AOT cache size over time, and to flag leaks.
+//
+// Usage: node --expose-gc bench/soak.js [options]
+//   --threads 1,2,4,8  thread counts of the scaling phase
+//   --vms 4            VMs per thread
+//   --scaling 10       seconds per thread count
+//   --duration 600     seconds of the soak phase, 0 to skip it
+//   --interval 10      seconds between two soak samples
+//   --payload 1024     bytes passed per call
+//   --aot              run AOT compiled code
+//   --swap 0           SwapModule() every N soak samples, 0 to never swap
+//   --max-rss-growth 64  MB per hour of RSS growth flagged as a leak
+//   --out report.json  write the report there instead of stdout
+//
+// It runs the bench_lib workloads built by bench.sh and needs no external
+// service. The soak samples are printed to stderr as they come. The exit
+// code is 1 when a leak is suspected:
+// - RSS keeps growing after the warmup, e.g. WasmEdge_String or contexts
+//   which are never deleted,
+// - the linear memory of a long-lived instance keeps growing, e.g. buffers
+//   from __wbindgen_malloc which are never freed,
+// - the AOT cache directory keeps getting new files.
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const {Worker, isMainThread, parentPort, workerData} =
+    require('worker_threads');
+const ssvm = require('../..');
+
+const libName = path.join(__dirname, 'pkg', 'bench_lib_bg.wasm');
+
+// Latency histogram with 1% wide buckets, cheap to merge across threads
+const kBuckets = 2048;
+const kRatio = Math.log(1.01);
+
+function newHistogram() { return new Float64Array(kBuckets); }
+
+function record(hist, us) {
+  let i = us <= 1 ? 0 : Math.ceil(Math.log(us) / kRatio);
+  hist[Math.min(kBuckets - 1, i)]++;
+}
+
+function merge(into, hist) {
+  for (let i = 0; i < kBuckets; i++) {
+    into[i] += hist[i];
+  }
+}
+
+function percentiles(hist) {
+  let total = hist.reduce((a, b) => a + b, 0);
+  let at = (p) => {
+    let seen = 0;
+    for (let i = 0; i < kBuckets; i++) {
+      seen += hist[i];
+      if (seen >= p * total) {
+        return Math.exp(i * kRatio);
+      }
+    }
+    return Infinity;
+  };
+  return {p50 : at(0.5), p99 : at(0.99), p999 : at(0.999)};
+}
+
+function payload(size) {
+  let bytes = new Uint8Array(size);
+  for (let i = 0; i < size; i++) {
+    bytes[i] = 97 + (i * 7) % 26;
+  }
+  return bytes;
+}
+
+// The calls of a worker rotate through the VMs and the Run* paths
+function runWorker() {
+  let {handle, vms, payloadSize, aot, durationMs, reportMs} = workerData;
+  let instances = [];
+  for (let i = 0; i < vms; i++) {
+    instances.push(new ssvm.VM(handle, {EnableAOT : aot}));
+  }
+  let bytes = payload(payloadSize);
+  let string = Buffer.from(bytes).toString('latin1');
+  let calls = [
+    (vm) => vm.RunUint8Array('echo_bytes', bytes).length === bytes.length,
+    (vm) => vm.RunString('echo_string', string).length === string.length,
+    (vm) => vm.RunInt('add_i32', 40, 2) === 42,
+  ];
+
+  let end = Date.now() + durationMs;
+  let nextReport = Date.now() + reportMs;
+  let hist = newHistogram();
+  let count = 0;
+  for (let n = 0; Date.now() < end; n++) {
+    let start = process.hrtime.bigint();
+    if (!calls[n % calls.length](instances[n % vms])) {
+      throw new Error('wrong result');
+    }
+    record(hist, Number(process.hrtime.bigint() - start) / 1e3);
+    count++;
+    if (Date.now() >= nextReport) {
+      parentPort.postMessage({calls : count, hist : hist});
+      hist = newHistogram();
+      count = 0;
+      nextReport += reportMs;
+    }
+  }
+  parentPort.postMessage({calls : count, hist : hist, done : true});
+}
+
+function parseArgs(argv) {
+  let args = {
+    threads : [ 1, 2, 4, os.cpus().length ],
+    vms : 4,
+    scaling : 10,
+    duration : 600,
+    interval : 10,
+    payload : 1024,
+    aot : false,
+    swap : 0,
+    maxRssGrowth : 64,
+    out : '',
+  };
+  for (let i = 0; i < argv.length; i++) {
+    let value = () => argv[++i];
+    switch (argv[i]) {
+    case '--threads':
+      args.threads = value().split(',').map((t) => parseInt(t));
+      break;
+    case '--vms':
+      args.vms = parseInt(value());
+      break;
+    case '--scaling':
+      args.scaling = parseFloat(value());
+      break;
+    case '--duration':
+      args.duration = parseFloat(value());
+      break;
+    case '--interval':
+      args.interval = parseFloat(value());
+      break;
+    case '--payload':
+      args.payload = parseInt(value());
+      break;
+    case '--aot':
+      args.aot = true;
+      break;
+    case '--swap':
+      args.swap = parseInt(value());
+      break;
+    case '--max-rss-growth':
+      args.maxRssGrowth = parseFloat(value());
+      break;
+    case '--out':
+      args.out = value();
+      break;
+    default:
+      console.error('Unknown option ' + argv[i] + ', see bench/soak.js');
+      process.exit(2);
+    }
+  }
+  args.threads = [...new Set(args.threads) ].filter((t) => t > 0);
+  return args;
+}
+
+// Start threads workers and call onReport for every report of every worker
+function runWorkers(threads, data, onReport) {
+  return Promise.all(Array.from({length : threads}, () => {
+    return new Promise((resolve, reject) => {
+      let worker = new Worker(__filename, {workerData : data});
+      worker.on('message', (msg) => {
+        onReport(msg);
+        if (msg.done) {
+          resolve();
+        }
+      });
+      worker.once('error', reject);
+    });
+  }));
+}
+
+function dirStats(dir) {
+  let stats = {files : 0, bytes : 0};
+  for (let name of fs.readdirSync(dir)) {
+    try {
+      stats.bytes += fs.statSync(path.join(dir, name)).size;
+      stats.files++;
+    } catch (e) {
+      // Removed meanwhile, e.g. a temporary compiler output
+    }
+  }
+  return stats;
+}
+
+function slopePerHour(samples, key) {
+  let n = samples.length;
+  let mx = samples.reduce((a, s) => a + s.t, 0) / n;
+  let my = samples.reduce((a, s) => a + s[key], 0) / n;
+  let num = 0, den = 0;
+  for (let s of samples) {
+    num += (s.t - mx) * (s[key] - my);
+    den += (s.t - mx) * (s.t - mx);
+  }
+  return den ? (num / den) * 3600 : 0;
+}
+
+async function scaling(args, data) {
+  let results = [];
+  for (let threads of args.threads) {
+    let hist = newHistogram();
+    let calls = 0;
+    let start = Date.now();
+    await runWorkers(threads, data, (msg) => {
+      calls += msg.calls;
+      merge(hist, msg.hist);
+    });
+    let seconds = (Date.now() - start) / 1000;
+    results.push(Object.assign({
+      threads : threads,
+      vms : threads * args.vms,
+      calls : calls,
+      callsPerSecond : calls / seconds,
+    },
+                               percentiles(hist)));
+  }
+  return results;
+}
+
+async function parallelScaling(args, vm) {
+  let inputs = Array.from({length : 256}, () => payload(args.payload));
+  let results = [];
+  for (let threads of args.threads) {
+    let calls = 0;
+    let start = Date.now();
+    while (Date.now() - start < args.scaling * 1000) {
+      let out = await vm.RunParallel('echo_bytes', inputs, threads);
+      if (out.length !== inputs.length) {
+        throw new Error('wrong result');
+      }
+      calls += inputs.length;
+    }
+    results.push({
+      threads : threads,
+      calls : calls,
+      callsPerSecond : calls / ((Date.now() - start) / 1000),
+    });
+  }
+  return results;
+}
+
+async function soak(args, data, cacheDir) {
+  let threads = Math.max(...args.threads);
+  let probe = new ssvm.VM(libName, {EnableAOT : args.aot});
+  let swapVm = new ssvm.VM(libName, {EnableAOT : args.aot});
+  let bytes = payload(args.payload);
+  probe.StreamBegin();
+
+  let samples = [];
+  let hist = newHistogram();
+  let calls = 0;
+  let swaps = 0;
+  let start = Date.now();
+  let last = start;
+  let sample = async () => {
+    // Keep a long-lived instance busy, its memory must not grow for good
+    for (let i = 0; i < 200; i++) {
+      probe.StreamWrite('echo_bytes', bytes);
+    }
+    if (args.swap && samples.length % args.swap === args.swap - 1) {
+      await swapVm.SwapModule(libName);
+      swapVm.RunUint8Array('echo_bytes', bytes);
+      swaps++;
+    }
+    if (global.gc) {
+      global.gc();
+    }
+    let now = Date.now();
+    let mem = process.memoryUsage();
+    let cache = dirStats(cacheDir);
+    let s = Object.assign({
+      t : (now - start) / 1000,
+      rss : mem.rss / 1048576,
+      heapUsed : mem.heapUsed / 1048576,
+      external : mem.external / 1048576,
+      cacheFiles : cache.files,
+      cacheBytes : cache.bytes,
+      memoryPages : probe.GetStatistics().MemoryPages,
+      calls : calls,
+      callsPerSecond : calls / ((now - last) / 1000),
+    },
+                          percentiles(hist));
+    samples.push(s);
+    console.error(JSON.stringify(s));
+    hist = newHistogram();
+    calls = 0;
+    last = now;
+  };
+
+  await sample();
+  let timer = setInterval(sample, args.interval * 1000);
+  await runWorkers(threads,
+                   Object.assign({}, data, {durationMs : args.duration * 1000}),
+                   (msg) => {
+                     calls += msg.calls;
+                     merge(hist, msg.hist);
+                   });
+  clearInterval(timer);
+  await sample();
+  probe.StreamEnd();
+
+  // Allocators and JIT settle during the first samples
+  let steady = samples.slice(Math.max(2, Math.floor(samples.length / 5)));
+  let leaks = [];
+  if (steady.length >= 3) {
+    let first = steady[0], lastSample = steady[steady.length - 1];
+    // Shorter runs are dominated by the heaps of the threads warming up
+    let rssGrowth = slopePerHour(steady, 'rss');
+    if (lastSample.t - first.t >= 300 && rssGrowth > args.maxRssGrowth) {
+      leaks.push(`RSS grows by ${rssGrowth.toFixed(1)} MB/hour`);
+    }
+    if (lastSample.memoryPages > first.memoryPages) {
+      leaks.push(`linear memory grew from ${first.memoryPages} to ${
+          lastSample.memoryPages} pages`);
+    }
+    if (lastSample.cacheFiles > first.cacheFiles) {
+      leaks.push(`AOT cache grew from ${first.cacheFiles} to ${
+          lastSample.cacheFiles} files`);
+    }
+  }
+  return {threads : threads, swaps : swaps, samples : samples, leaks : leaks};
+}
+
+async function main() {
+  let args = parseArgs(process.argv.slice(2));
+  // A private cache, so that its growth is only caused by this run
+  let cacheDir = process.env.WASMEDGE_CACHE_DIR;
+  if (!cacheDir) {
+    cacheDir = fs.mkdtempSync(path.join(os.tmpdir(), 'wasmedge-soak-'));
+    process.env.WASMEDGE_CACHE_DIR = cacheDir;
+  }
+
+  let vm = new ssvm.VM(libName, {EnableAOT : args.aot});
+  let data = {
+    handle : vm.Share(),
+    vms : args.vms,
+    payloadSize : args.payload,
+    aot : args.aot,
+    durationMs : args.scaling * 1000,
+    reportMs : args.interval * 1000,
+  };
+
+  let report = {
+    benchmark : 'soak',
+    date : new Date().toISOString(),
+    addon : require('../../package.json').version,
+    node : process.version,
+    cpus : os.cpus().length,
+    options : args,
+    gc : !!global.gc,
+    scaling : await scaling(args, data),
+    parallelScaling : await parallelScaling(args, vm),
+  };
+  if (args.duration > 0) {
+    report.soak = await soak(args, data, cacheDir);
+  }
+  ssvm.VM.ReleaseSharedModule(data.handle);
+
+  let text = JSON.stringify(report, null, 2);
+  if (args.out) {
+    fs.writeFileSync(args.out, text + '\n');
+  } else {
+    console.log(text);
+  }
+  if (report.soak && report.soak.leaks.length) {
+    console.error('Suspected leaks:\n  ' + report.soak.leaks.join('\n  '));
+    process.exitCode = 1;
+  }
+}
+
+if (isMainThread) {
+  main().catch((e) => {
+    console.error(e);
+    process.exitCode = 1;
+  });
+} else {
+  runWorker();
+}
@@ -0,0 +1,15 @@
+;; Source of multi_value.wasm, exports returning a byte buffer either as
+;; (ptr, len) with multi-value or through a return pointer like wasm-bindgen.
+(module
+  (memory (export "memory") 1)
+  (global $top (mut i32) (i32.const 1024))
+  (func (export "__wbindgen_malloc") (param i32) (result i32)
+    global.get $top global.get $top local.get 0 i32.add global.set $top)
+  (func (export "__wbindgen_free") (param i32 i32))
+  ;; Drop the first byte, returning (ptr, len) with multi-value
+  (func (export "tail") (param $ptr i32) (param $len i32) (result i32 i32)
+    local.get $ptr i32.const 1 i32.add local.get $len i32.const 1 i32.sub)
+  ;; Same through a return pointer
+  (func (export "tail_ret") (param $ret i32) (param $ptr i32) (param $len i32)
+    local.get $ret local.get $ptr i32.const 1 i32.add i32.store
+    local.get $ret local.get $len i32.const 1 i32.sub i32.store offset=4))
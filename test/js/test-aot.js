@@ -1,5 +1,8 @@
 const assert = require('assert');
+const child_process = require('child_process');
 const fs = require('fs');
+const os = require('os');
+const path = require('path');
 const ssvm = require('../..');
 
 describe('aot', function() {
@@ -93,4 +96,178 @@ describe('aot', function() {
       }
     });
   });
+
+  describe('universal', function() {
+    this.timeout(0);
+
+    let universalName = 'pkg/integers_lib_bg.universal.wasm';
+    let cacheDir;
+    let savedCacheDir = process.env.WASMEDGE_CACHE_DIR;
+
+    before(function() {
+      cacheDir = fs.mkdtempSync(path.join(os.tmpdir(), 'wasmedge-cache-'));
+      process.env.WASMEDGE_CACHE_DIR = cacheDir;
+      assert.ok(new ssvm.VM(inputName).Compile(universalName));
+    });
+
+    it('is still a wasm module', function() {
+      let bytes = fs.readFileSync(universalName);
+      assert.deepEqual([...bytes.subarray(0, 4) ], [ 0x00, 0x61, 0x73, 0x6d ]);
+      assert.ok(bytes.length > fs.statSync(inputName).size);
+    });
+
+    it('runs the embedded code on this host', function() {
+      let vm = new ssvm.VM(universalName);
+      // The embedded code is used as is, there is nothing to compile
+      assert.equal(vm.Precompile().Cached, true);
+      assert.equal(vm.RunInt('lcm_s32', 123, 1011), 41451);
+    });
+
+    it('falls back to the plain module on a mismatch', function() {
+      // Compiled without the threads proposal
+      let vm = new ssvm.VM(fs.readFileSync(universalName),
+                           {EnableThreads : true});
+      assert.equal(vm.RunInt('lcm_s32', 123, 1011), 41451);
+      assert.equal(vm.Precompile().Cached, false);
+    });
+
+    after(function() {
+      if (savedCacheDir === undefined) {
+        delete process.env.WASMEDGE_CACHE_DIR;
+      } else {
+        process.env.WASMEDGE_CACHE_DIR = savedCacheDir;
+      }
+      for (let name of fs.readdirSync(cacheDir)) {
+        fs.unlinkSync(path.join(cacheDir, name));
+      }
+      fs.rmdirSync(cacheDir);
+      if (fs.existsSync(universalName)) {
+        fs.unlinkSync(universalName);
+      }
+    });
+  });
+
+  describe('precompile', function() {
+    this.timeout(0);
+
+    let cacheDir;
+    let savedCacheDir = process.env.WASMEDGE_CACHE_DIR;
+
+    before(function() {
+      cacheDir = fs.mkdtempSync(path.join(os.tmpdir(), 'wasmedge-cache-'));
+      process.env.WASMEDGE_CACHE_DIR = cacheDir;
+    });
+
+    it('warms the cache used by EnableAOT', function() {
+      let first = new ssvm.VM(inputName, {EnableAOT : true}).Precompile();
+      assert.equal(first.Cached, false);
+      assert.equal(path.dirname(first.Path), cacheDir);
+      assert.ok(fs.existsSync(first.Path));
+
+      let vm = new ssvm.VM(fs.readFileSync(inputName), {EnableAOT : true});
+      let second = vm.Precompile();
+      assert.equal(second.Cached, true);
+      assert.equal(second.Path, first.Path);
+      assert.equal(vm.RunInt('lcm_s32', 123, 1011), 41451);
+    });
+
+    it('keys the cache by compiler options', function() {
+      let res = new ssvm.VM(inputName, {
+                  EnableAOT : true,
+                  AOTOptimizationLevel : 'O0',
+                }).Precompile();
+      assert.equal(res.Cached, false);
+    });
+
+    after(function() {
+      if (savedCacheDir === undefined) {
+        delete process.env.WASMEDGE_CACHE_DIR;
+      } else {
+        process.env.WASMEDGE_CACHE_DIR = savedCacheDir;
+      }
+      for (let name of fs.readdirSync(cacheDir)) {
+        fs.unlinkSync(path.join(cacheDir, name));
+      }
+      fs.rmdirSync(cacheDir);
+    });
+  });
+
+  describe('single flight', function() {
+    this.timeout(0);
+
+    let cacheDir;
+    let savedCacheDir = process.env.WASMEDGE_CACHE_DIR;
+    let addon = path.resolve(__dirname, '../..');
+
+    // Run Precompile() in another process and resolve to its result
+    function precompileIn(options) {
+      let script = `const ssvm = require(${JSON.stringify(addon)});
+        let vm = new ssvm.VM(${JSON.stringify(inputName)},
+                             ${JSON.stringify(options)});
+        console.log(JSON.stringify(vm.Precompile()));`;
+      return new Promise((resolve, reject) => {
+        child_process.execFile(process.execPath, [ '-e', script ],
+                               (err, stdout) => err
+                                   ? reject(err)
+                                   : resolve(JSON.parse(stdout)));
+      });
+    }
+
+    before(function() {
+      cacheDir = fs.mkdtempSync(path.join(os.tmpdir(), 'wasmedge-cache-'));
+      process.env.WASMEDGE_CACHE_DIR = cacheDir;
+    });
+
+    it('compiles an entry in one process only', async function() {
+      let results = await Promise.all([ precompileIn({}), precompileIn({}) ]);
+      assert.equal(results[0].Path, results[1].Path);
+      assert.equal(results.filter((res) => !res.Cached).length, 1);
+      // The compiler output is renamed into place, no partial file is left
+      assert.deepEqual(fs.readdirSync(cacheDir).filter(
+                           (name) => !/\.(so|lock)$/.test(name)),
+                       []);
+    });
+
+    it('falls back to the interpreter when the wait times out',
+       async function() {
+         let options = {AOTOptimizationLevel : 'O1'};
+         let entry = (await precompileIn(options)).Path;
+         fs.unlinkSync(entry);
+
+         // Hold the lock of the entry as if another process was compiling
+         let holder = child_process.spawn(
+             'flock', [ entry + '.lock', '-c', 'echo locked; sleep 60' ],
+             {detached : true});
+         let locked = await new Promise((resolve) => {
+           holder.on('error', () => resolve(false));
+           holder.stdout.once('data', () => resolve(true));
+         });
+         if (!locked) {
+           this.skip();
+         }
+         try {
+           let vm = new ssvm.VM(inputName, Object.assign({
+             EnableAOT : true,
+             AOTCompileTimeout : 100,
+           }, options));
+           assert.equal(vm.RunInt('lcm_s32', 123, 1011), 41451);
+           assert.ok(!fs.existsSync(entry));
+         } finally {
+           // The whole group, the shell of flock holds the lock as well
+           process.kill(-holder.pid);
+         }
+       });
+
+    after(function() {
+      if (savedCacheDir === undefined) {
+        delete process.env.WASMEDGE_CACHE_DIR;
+      } else {
+        process.env.WASMEDGE_CACHE_DIR = savedCacheDir;
+      }
+      for (let name of fs.readdirSync(cacheDir)) {
+        fs.unlinkSync(path.join(cacheDir, name));
+      }
+      fs.rmdirSync(cacheDir);
+    });
+  });
 });
@@ -0,0 +1,53 @@
+const assert = require('assert');
+const ssvm = require('../..');
+
+describe('calling conventions', function() {
+  let inputName = 'pkg/integers_lib_bg.wasm';
+  // See data/multi_value.wat
+  let multiValueName = 'data/multi_value.wasm';
+
+  it('passes i64 values in registers when the export takes them',
+     function() {
+       let vm = new ssvm.VM(inputName);
+       // lcm_s64 splits the values, the native ones take them directly
+       assert.equal(vm.RunInt64('lcm_s64', 2147483647, 2), 4294967294);
+       assert.equal(vm.RunInt64('lcm_s64_native', 2147483647, 2), 4294967294);
+       assert.equal(vm.RunInt64('lcm_s64_native', -6, 4), 12);
+       assert.equal(vm.RunUInt64('lcm_u64_native', 4294967296, 3),
+                    12884901888);
+       // Only the native convention takes BigInt arguments
+       assert.strictEqual(vm.RunInt64('lcm_s64_native', 123n, 1011n), 41451n);
+       assert.strictEqual(vm.RunUInt64('lcm_u64_native', 123n, 1011n), 41451n);
+     });
+
+  it('keeps i64 values over 2^53 passed as BigInt', function() {
+    let vm = new ssvm.VM(inputName);
+    assert.strictEqual(vm.RunInt64('lcm_s64_native', 2n ** 53n + 1n, 1n),
+                       9007199254740993n);
+    assert.strictEqual(vm.RunInt64('lcm_s64_native', 2n ** 62n + 1n, 1n),
+                       4611686018427387905n);
+    assert.strictEqual(vm.RunUInt64('lcm_u64_native', 2n ** 63n + 1n, 1n),
+                       9223372036854775809n);
+    // Number arguments still get a Number back
+    assert.strictEqual(vm.RunInt64('lcm_s64_native', 6, 4), 12);
+  });
+
+  it('reads (ptr, len) results from either convention', function() {
+    let vm = new ssvm.VM(multiValueName);
+    assert.equal(Buffer.from(vm.RunUint8Array('tail', 'abc')).toString(),
+                 'bc');
+    assert.equal(Buffer.from(vm.RunUint8Array('tail_ret', 'abc')).toString(),
+                 'bc');
+    assert.equal(vm.RunString('tail', 'abc'), 'bc');
+    assert.equal(vm.RunString('tail_ret', 'abc'), 'bc');
+  });
+
+  it('reads (ptr, len) results from either convention in RunAsync',
+     async function() {
+       let vm = new ssvm.VM(multiValueName);
+       let results = await Promise.all(
+           [ 'tail', 'tail_ret' ].map((f) => vm.RunAsync(f, 'abcd')));
+       assert.deepEqual(results.map((r) => Buffer.from(r).toString()),
+                        [ 'bcd', 'bcd' ]);
+     });
+});
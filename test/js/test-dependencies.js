@@ -0,0 +1,80 @@
+const assert = require('assert');
+const ssvm = require('../..');
+
+describe('dependencies', function() {
+  // (module (func (export "twice") (param i32) (result i32)
+  //   local.get 0 local.get 0 i32.add))
+  let util = new Uint8Array([
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x06, 0x01, 0x60,
+    0x01, 0x7f, 0x01, 0x7f, 0x03, 0x02, 0x01, 0x00, 0x07, 0x09, 0x01, 0x05,
+    0x74, 0x77, 0x69, 0x63, 0x65, 0x00, 0x00, 0x0a, 0x09, 0x01, 0x07, 0x00,
+    0x20, 0x00, 0x20, 0x00, 0x6a, 0x0b,
+  ]);
+  // (module (import "util" "twice" (func $twice (param i32) (result i32)))
+  //   (memory (export "memory") 1)
+  //   (func (export "quad") (param i32) (result i32)
+  //     local.get 0 call $twice call $twice))
+  let main = new Uint8Array([
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x06, 0x01, 0x60,
+    0x01, 0x7f, 0x01, 0x7f, 0x02, 0x0e, 0x01, 0x04, 0x75, 0x74, 0x69, 0x6c,
+    0x05, 0x74, 0x77, 0x69, 0x63, 0x65, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00,
+    0x05, 0x03, 0x01, 0x00, 0x01, 0x07, 0x11, 0x02, 0x06, 0x6d, 0x65, 0x6d,
+    0x6f, 0x72, 0x79, 0x02, 0x00, 0x04, 0x71, 0x75, 0x61, 0x64, 0x00, 0x01,
+    0x0a, 0x0a, 0x01, 0x08, 0x00, 0x20, 0x00, 0x10, 0x00, 0x10, 0x00, 0x0b,
+  ]);
+
+  it('links the dependencies into every call', function() {
+    let vm = new ssvm.VM(main, {Dependencies : {util : util}});
+    assert.equal(vm.RunInt('quad', 5), 20);
+    assert.equal(vm.RunInt('quad', 7), 28);
+    // Another VM reuses the module prepared by the first one
+    let other = new ssvm.VM(main, {Dependencies : {util : util}});
+    assert.equal(other.RunInt('quad', 1), 4);
+  });
+
+  // (module
+  //   (import "wasi_snapshot_preview1" "proc_exit" (func (param i32)))
+  //   (memory (export "memory") 1)
+  //   (func (export "twice") (param i32) (result i32)
+  //     local.get 0 local.get 0 i32.add))
+  let wasiMain = new Uint8Array([
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x0a, 0x02, 0x60,
+    0x01, 0x7f, 0x00, 0x60, 0x01, 0x7f, 0x01, 0x7f, 0x02, 0x24, 0x01, 0x16,
+    0x77, 0x61, 0x73, 0x69, 0x5f, 0x73, 0x6e, 0x61, 0x70, 0x73, 0x68, 0x6f,
+    0x74, 0x5f, 0x70, 0x72, 0x65, 0x76, 0x69, 0x65, 0x77, 0x31, 0x09, 0x70,
+    0x72, 0x6f, 0x63, 0x5f, 0x65, 0x78, 0x69, 0x74, 0x00, 0x00, 0x03, 0x02,
+    0x01, 0x01, 0x05, 0x03, 0x01, 0x00, 0x01, 0x07, 0x12, 0x02, 0x06, 0x6d,
+    0x65, 0x6d, 0x6f, 0x72, 0x79, 0x02, 0x00, 0x05, 0x74, 0x77, 0x69, 0x63,
+    0x65, 0x00, 0x01, 0x0a, 0x09, 0x01, 0x07, 0x00, 0x20, 0x00, 0x20, 0x00,
+    0x6a, 0x0b,
+  ]);
+
+  it('registers only the imported host modules', function() {
+    // Modules of the same name as the WASI and process host modules can only
+    // be registered when the host ones are not
+    let hostNames = {
+      util : util,
+      wasi_snapshot_preview1 : util,
+      wasmedge_process : util,
+    };
+    let vm = new ssvm.VM(main, {Dependencies : hostNames});
+    assert.equal(vm.RunInt('quad', 5), 20);
+    assert.equal(vm.RunInt('quad', 7), 28);
+    // A module importing WASI gets the host module, which then conflicts
+    let wasi = new ssvm.VM(
+        wasiMain, {Dependencies : {wasi_snapshot_preview1 : util}});
+    assert.throws(() => wasi.RunInt('twice', 5));
+    assert.equal(new ssvm.VM(wasiMain).RunInt('twice', 5), 10);
+  });
+
+  it('fails without the dependency', function() {
+    let vm = new ssvm.VM(main);
+    assert.throws(() => vm.RunInt('quad', 5));
+  });
+
+  it('checks the option', function() {
+    assert.throws(() => new ssvm.VM(main, {Dependencies : {util : 42}}));
+    assert.throws(() => new ssvm.VM(
+                      main, {Dependencies : {util : new Uint8Array(8)}}));
+  });
+});
@@ -0,0 +1,60 @@
+const assert = require('assert');
+const ssvm = require('../..');
+
+describe('gas', function() {
+  let inputName = 'pkg/integers_lib_bg.wasm';
+
+  it('reports the cost of each call', function() {
+    let vm = new ssvm.VM(inputName);
+    assert.equal(vm.RunInt('lcm_s32', 123, 1011), 41451);
+    let first = vm.GetCallStatistics();
+    assert.ok(first.InstructionCount > 0);
+    assert.equal(first.TotalGasCost, first.InstructionCount);
+    assert.ok(first.WallTime > 0);
+    assert.equal(first.GasLimitExceeded, false);
+
+    vm.RunInt('lcm_s32', 123, 1011);
+    let second = vm.GetCallStatistics();
+    assert.equal(second.InstructionCount, first.InstructionCount);
+  });
+
+  it('uses the cost table', function() {
+    let vm = new ssvm.VM(inputName, {CostTable : new Array(256).fill(2)});
+    vm.RunInt('lcm_s32', 123, 1011);
+    let stat = vm.GetCallStatistics();
+    assert.equal(stat.TotalGasCost, 2 * stat.InstructionCount);
+  });
+
+  it('does not count loading the module for other instances', function() {
+    let vm = new ssvm.VM(inputName, {EnableMeasurement : true});
+    assert.equal(vm.RunInt('lcm_s32', 123, 1011), 41451);
+    let last = vm.GetCallStatistics();
+    let total = vm.GetStatistics().InstructionCount;
+    vm.Session('a').RunUint8Array('accumulate', 'abc');
+    assert.deepEqual(vm.GetCallStatistics(), last);
+    assert.equal(vm.GetStatistics().InstructionCount, total);
+  });
+
+  it('aborts calls over the gas limit', function() {
+    let vm = new ssvm.VM(inputName, {GasLimit : 10});
+    assert.throws(() => vm.RunInt('lcm_s32', 123, 1011), /gas limit/);
+    assert.ok(vm.GetCallStatistics().GasLimitExceeded);
+
+    vm.SetGasLimit(0);
+    assert.equal(vm.RunInt('lcm_s32', 123, 1011), 41451);
+    assert.equal(vm.GetCallStatistics().GasLimitExceeded, false);
+  });
+
+  it('rejects invalid limits', function() {
+    assert.throws(() => new ssvm.VM(inputName, {GasLimit : -1}));
+    assert.throws(() => new ssvm.VM(inputName, {CostTable : [ 'a' ]}));
+    assert.throws(() => new ssvm.VM(inputName).SetGasLimit(-1));
+  });
+
+  it('only changes the limit of a metered VM', function() {
+    assert.throws(() => new ssvm.VM(inputName).SetGasLimit(10), /metering/);
+    let vm = new ssvm.VM(inputName, {EnableMeasurement : true});
+    vm.SetGasLimit(10);
+    assert.throws(() => vm.RunInt('lcm_s32', 123, 1011), /gas limit/);
+  });
+});
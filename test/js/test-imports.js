@@ -0,0 +1,145 @@
+const assert = require('assert');
+const v8 = require('v8');
+const {runInNewContext} = require('vm');
+const ssvm = require('../..');
+
+v8.setFlagsFromString('--expose-gc');
+const gc = runInNewContext('gc');
+
+describe('imports', function() {
+  // (module
+  //   (import "host" "add" (func $add (param i32 i32) (result i32)))
+  //   (import "host" "log" (func $log (param i32 i32)))
+  //   (memory (export "memory") 1)
+  //   (global $top (mut i32) (i32.const 1024))
+  //   (func (export "__wbindgen_malloc") (param i32) (result i32)
+  //     global.get $top global.get $top local.get 0 i32.add global.set $top)
+  //   (func (export "__wbindgen_free") (param i32 i32))
+  //   (func (export "sum") (param i32 i32) (result i32)
+  //     local.get 0 local.get 1 call $add)
+  //   ;; Log the input and return it, with the length given by $add
+  //   (func (export "echo") (param $ret i32) (param $ptr i32) (param $len i32)
+  //     local.get $ptr local.get $len call $log
+  //     local.get $ret local.get $ptr i32.store
+  //     local.get $ret local.get $len i32.const 0 call $add
+  //     i32.store offset=4))
+  let main = new Uint8Array([
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x17, 0x04, 0x60,
+    0x02, 0x7f, 0x7f, 0x01, 0x7f, 0x60, 0x02, 0x7f, 0x7f, 0x00, 0x60, 0x01,
+    0x7f, 0x01, 0x7f, 0x60, 0x03, 0x7f, 0x7f, 0x7f, 0x00, 0x02, 0x17, 0x02,
+    0x04, 0x68, 0x6f, 0x73, 0x74, 0x03, 0x61, 0x64, 0x64, 0x00, 0x00, 0x04,
+    0x68, 0x6f, 0x73, 0x74, 0x03, 0x6c, 0x6f, 0x67, 0x00, 0x01, 0x03, 0x05,
+    0x04, 0x02, 0x01, 0x00, 0x03, 0x05, 0x03, 0x01, 0x00, 0x01, 0x06, 0x07,
+    0x01, 0x7f, 0x01, 0x41, 0x80, 0x08, 0x0b, 0x07, 0x3d, 0x05, 0x06, 0x6d,
+    0x65, 0x6d, 0x6f, 0x72, 0x79, 0x02, 0x00, 0x11, 0x5f, 0x5f, 0x77, 0x62,
+    0x69, 0x6e, 0x64, 0x67, 0x65, 0x6e, 0x5f, 0x6d, 0x61, 0x6c, 0x6c, 0x6f,
+    0x63, 0x00, 0x02, 0x0f, 0x5f, 0x5f, 0x77, 0x62, 0x69, 0x6e, 0x64, 0x67,
+    0x65, 0x6e, 0x5f, 0x66, 0x72, 0x65, 0x65, 0x00, 0x03, 0x03, 0x73, 0x75,
+    0x6d, 0x00, 0x04, 0x04, 0x65, 0x63, 0x68, 0x6f, 0x00, 0x05, 0x0a, 0x34,
+    0x04, 0x0b, 0x00, 0x23, 0x00, 0x23, 0x00, 0x20, 0x00, 0x6a, 0x24, 0x00,
+    0x0b, 0x02, 0x00, 0x0b, 0x08, 0x00, 0x20, 0x00, 0x20, 0x01, 0x10, 0x00,
+    0x0b, 0x1a, 0x00, 0x20, 0x01, 0x20, 0x02, 0x10, 0x01, 0x20, 0x00, 0x20,
+    0x01, 0x36, 0x02, 0x00, 0x20, 0x00, 0x20, 0x02, 0x41, 0x00, 0x10, 0x00,
+    0x36, 0x02, 0x04, 0x0b,
+  ]);
+
+  function hostImports(add, log) {
+    return {
+      host : {
+        add : {params : [ 'i32', 'i32' ], results : [ 'i32' ], func : add},
+        log : {params : [ 'bytes' ], func : log},
+      },
+    };
+  }
+
+  async function until(cond) {
+    while (!cond()) {
+      await new Promise((resolve) => setTimeout(resolve, 1));
+    }
+  }
+
+  it('calls imports on the JS thread', function() {
+    let logged = [];
+    let vm = new ssvm.VM(main, {
+      imports : hostImports((a, b) => a + b,
+                            (bytes) => logged.push(Buffer.from(bytes))),
+    });
+    assert.equal(vm.RunInt('sum', 2, 3), 5);
+    assert.deepEqual(Buffer.from(vm.RunUint8Array('echo', 'abc')),
+                     Buffer.from('abc'));
+    assert.deepEqual(logged, [ Buffer.from('abc') ]);
+  });
+
+  it('rethrows exceptions on the JS thread', function() {
+    let vm = new ssvm.VM(main, {
+      imports : hostImports(() => { throw new Error('boom'); }, () => {}),
+    });
+    assert.throws(() => vm.RunInt('sum', 2, 3), /boom/);
+  });
+
+  it('forwards calls from RunAsync to the JS thread', async function() {
+    let logged = [];
+    let vm = new ssvm.VM(main, {
+      imports : hostImports((a, b) => a + b,
+                            (bytes) => logged.push(Buffer.from(bytes))),
+    });
+    let results = await Promise.all(
+        [ 'a', 'bc', 'def' ].map((input) => vm.RunAsync('echo', input)));
+    assert.deepEqual(results.map((bytes) => Buffer.from(bytes).toString()),
+                     [ 'a', 'bc', 'def' ]);
+    // Calls without results are not waited for
+    await until(() => logged.length == 3);
+    assert.deepEqual(logged.map((bytes) => bytes.toString()).sort(),
+                     [ 'a', 'bc', 'def' ]);
+  });
+
+  it('reports exceptions of forwarded calls', async function() {
+    let vm = new ssvm.VM(main, {
+      imports : hostImports(() => { throw new Error('boom'); }, () => {}),
+    });
+    await assert.rejects(vm.RunAsync('echo', 'abc'), /host\.add: .*boom/);
+  });
+
+  it('reports exceptions of queued calls to the call which made them',
+     async function() {
+       let vm = new ssvm.VM(main, {
+         imports : hostImports((a, b) => a + b,
+                               (bytes) => {
+                                 if (Buffer.from(bytes).toString() == 'bad') {
+                                   throw new Error('boom');
+                                 }
+                               }),
+       });
+       let results = await Promise.allSettled(
+           [ 'ok', 'bad', 'fine' ].map((input) => vm.RunAsync('echo', input)));
+       assert.deepEqual(results.map((r) => r.status),
+                        [ 'fulfilled', 'rejected', 'fulfilled' ]);
+       assert.match(results[1].reason.message, /host\.log: .*boom/);
+       // Nothing is left over for the following calls
+       await vm.RunAsync('echo', 'abc');
+     });
+
+  it('runs the queued calls of a VM which is dropped', async function() {
+    let logged = 0;
+    let pending = [];
+    (function() {
+      let vm = new ssvm.VM(main, {
+        imports : hostImports((a, b) => a + b, () => { logged++; }),
+      });
+      for (let i = 0; i < 100; i++) {
+        pending.push(vm.RunAsync('echo', 'abc'));
+      }
+    })();
+    await Promise.all(pending);
+    // A call completes only once its queued calls ran
+    assert.equal(logged, 100);
+    gc();
+    await new Promise((resolve) => setTimeout(resolve, 10));
+    gc();
+    let vm = new ssvm.VM(main, {
+      imports : hostImports((a, b) => a + b, () => { logged++; }),
+    });
+    await vm.RunAsync('echo', 'abc');
+    assert.equal(logged, 101);
+  });
+});
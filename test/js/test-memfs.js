@@ -0,0 +1,63 @@
+const assert = require('assert');
+const path = require('path');
+const ssvm = require('../..');
+
+describe('memfs', function() {
+  let commandName = path.join('target', 'wasm32-wasi', 'release',
+                              'copy_upper.wasm');
+  let csv = 'name,count\nfoo,1\nbar,2\n';
+
+  function text(bytes) { return Buffer.from(bytes).toString(); }
+
+  // Like process.argv, the first two entries of args are dropped
+  function copyUpper(memfs, ...args) {
+    return new ssvm.VM(commandName, {
+      EnableWasiStartFunction : true,
+      args : [ 'node', 'script.js', ...args ],
+      memfs : memfs,
+      CaptureOutput : true,
+    });
+  }
+
+  it('reads a preloaded file', function() {
+    let result =
+        copyUpper({'/in' : {'data.csv' : csv}}, '/in/data.csv').Start();
+    assert.equal(result.ErrorCode, 0);
+    assert.equal(text(result.Stdout), csv);
+    assert.deepEqual(Object.keys(result.Files), [ '/in' ]);
+    assert.equal(text(result.Files['/in']['data.csv']), csv);
+  });
+
+  it('returns the files written by the application', function() {
+    let memfs = {'/in' : {'data.csv' : Buffer.from(csv)}, '/out' : {}};
+    let result =
+        copyUpper(memfs, '/in/data.csv', '/out/upper.csv').Start();
+    assert.equal(result.ErrorCode, 0);
+    assert.equal(text(result.Files['/out']['upper.csv']), csv.toUpperCase());
+    assert.deepEqual(Object.keys(result.Files['/out']), [ 'upper.csv' ]);
+    assert.equal(text(result.Files['/in']['data.csv']), csv);
+  });
+
+  it('captures stdout and stderr separately', function() {
+    let result = copyUpper({'/in' : {'data.csv' : csv}, '/out' : {}},
+                           '/in/data.csv', '/out/upper.csv')
+                     .Start();
+    assert.equal(text(result.Stdout), csv);
+    assert.equal(text(result.Stderr),
+                 'copied /in/data.csv to /out/upper.csv\n');
+  });
+
+  it('does not leak output between VMs capturing in turn', function() {
+    let first = copyUpper({'/in' : {'a.txt' : 'first\n'}}, '/in/a.txt');
+    let second = copyUpper({'/in' : {'b.txt' : 'second\n'}}, '/in/b.txt');
+    let firstResult = first.Start();
+    let secondResult = second.Start();
+    assert.equal(text(firstResult.Stdout), 'first\n');
+    assert.equal(text(firstResult.Stderr), 'read /in/a.txt\n');
+    assert.equal(text(secondResult.Stdout), 'second\n');
+    assert.equal(text(secondResult.Stderr), 'read /in/b.txt\n');
+    // Each VM only sees its own directories
+    assert.deepEqual(Object.keys(firstResult.Files['/in']), [ 'a.txt' ]);
+    assert.deepEqual(Object.keys(secondResult.Files['/in']), [ 'b.txt' ]);
+  });
+});
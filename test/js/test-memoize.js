@@ -0,0 +1,80 @@
+const assert = require('assert');
+const ssvm = require('../..');
+
+describe('memoize', function() {
+  let inputName = 'pkg/integers_lib_bg.wasm';
+
+  function counters(vm) {
+    let stat = vm.GetStatistics();
+    return {
+      hits : stat.MemoHits,
+      misses : stat.MemoMisses,
+      evictions : stat.MemoEvictions,
+      entries : stat.MemoEntries,
+    };
+  }
+
+  it('returns the cached result of the same arguments', function() {
+    let vm = new ssvm.VM(inputName, {Memoize : [ 'echo' ]});
+    let first = vm.RunUint8Array('echo', 'abc');
+    assert.deepStrictEqual(vm.RunUint8Array('echo', 'abc'), first);
+    // A hit runs nothing
+    assert.equal(vm.GetCallStatistics().InstructionCount, 0);
+    assert.deepStrictEqual([...vm.RunUint8Array('echo', 'abd') ],
+                           [...Buffer.from('abd') ]);
+    assert.deepStrictEqual(counters(vm),
+                           {hits : 1, misses : 2, evictions : 0, entries : 2});
+
+    // Functions which are not listed are never cached
+    vm.RunUint8Array('accumulate', 'abc');
+    vm.RunUint8Array('accumulate', 'abc');
+    assert.equal(counters(vm).hits, 1);
+  });
+
+  it('keys numbers the way they are passed to the function', function() {
+    let vm = new ssvm.VM(inputName, {Memoize : [ 'repeat_a' ]});
+    assert.equal(vm.RunString('repeat_a', 1), 'a');
+    // Both are passed as the i32 1, so they share the result by design
+    assert.equal(vm.RunString('repeat_a', 1.5), 'a');
+    assert.equal(vm.RunString('repeat_a', 2), 'aa');
+    assert.deepStrictEqual(counters(vm),
+                           {hits : 1, misses : 2, evictions : 0, entries : 2});
+  });
+
+  it('evicts the least recently used results beyond the limit', function() {
+    // Two results of 100 bytes fit, with their keys, but not three
+    let vm = new ssvm.VM(inputName,
+                         {Memoize : [ 'echo' ], MemoizeMaxBytes : 600});
+    let input = (fill) => new Uint8Array(100).fill(fill);
+    vm.RunUint8Array('echo', input(1));
+    vm.RunUint8Array('echo', input(2));
+    vm.RunUint8Array('echo', input(1));
+    vm.RunUint8Array('echo', input(3));
+    assert.deepStrictEqual(counters(vm),
+                           {hits : 1, misses : 3, evictions : 1, entries : 2});
+    assert.ok(vm.GetStatistics().MemoBytes <= 600);
+
+    // input(2) was the least recently used one
+    vm.RunUint8Array('echo', input(1));
+    vm.RunUint8Array('echo', input(2));
+    assert.deepStrictEqual(counters(vm),
+                           {hits : 2, misses : 4, evictions : 2, entries : 2});
+
+    // A result larger than the whole cache is not kept
+    vm.RunUint8Array('echo', new Uint8Array(1000));
+    vm.RunUint8Array('echo', new Uint8Array(1000));
+    assert.deepStrictEqual(counters(vm),
+                           {hits : 2, misses : 6, evictions : 2, entries : 2});
+  });
+
+  it('clears the cache when the module is swapped', async function() {
+    let vm = new ssvm.VM(inputName, {Memoize : [ 'echo' ]});
+    vm.RunUint8Array('echo', 'abc');
+    vm.RunUint8Array('echo', 'abc');
+    assert.ok((await vm.SwapModule(inputName)).Applied);
+    assert.equal(counters(vm).entries, 0);
+    vm.RunUint8Array('echo', 'abc');
+    assert.deepStrictEqual(counters(vm),
+                           {hits : 1, misses : 2, evictions : 0, entries : 1});
+  });
+});
@@ -0,0 +1,129 @@
+const assert = require('assert');
+const ssvm = require('../..');
+
+describe('msgpack', function() {
+  let inputName = 'pkg/integers_lib_bg.wasm';
+  let vm;
+
+  before(function() { vm = new ssvm.VM(inputName); });
+
+  // The guest returns its input, so a value goes through both directions
+  function roundTrip(value) { return vm.RunValue('echo', value); }
+  // The guest returns the given bytes as they are, for the decoder alone
+  function decode(bytes) {
+    return vm.RunValue('unwrap_bin', new Uint8Array(bytes));
+  }
+  function str(s) { return [ 0xa0 | s.length, ...Buffer.from(s) ]; }
+
+  it('round-trips nil, booleans and numbers', function() {
+    let values = [
+      null, true, false, 0, 1, 127, 128, 255, 256, 65535, 65536,
+      2 ** 32 - 1, 2 ** 32, Number.MAX_SAFE_INTEGER, -1, -32, -33, -128,
+      -129, -32768, -32769, -(2 ** 31), -(2 ** 31) - 1,
+      -Number.MAX_SAFE_INTEGER, 1.5, -0.25, 1e300, Infinity, NaN
+    ];
+    for (let value of values) {
+      assert.deepStrictEqual(roundTrip(value), value);
+    }
+    assert.strictEqual(roundTrip(undefined), null);
+  });
+
+  it('round-trips BigInts outside the safe range', function() {
+    for (let value of [ 2n ** 53n, 2n ** 63n, 2n ** 64n - 1n, -(2n ** 63n) ]) {
+      assert.strictEqual(roundTrip(value), value);
+    }
+    // Safe integers come back as numbers
+    assert.strictEqual(roundTrip(5n), 5);
+    assert.throws(() => roundTrip(2n ** 64n), /MessagePack/);
+  });
+
+  it('round-trips strings and binary data of every size', function() {
+    for (let size of [ 0, 31, 32, 255, 256, 65535, 65536 ]) {
+      let s = 'x'.repeat(size);
+      assert.strictEqual(roundTrip(s), s);
+      let bytes = new Uint8Array(size).map((_, i) => i);
+      assert.deepStrictEqual(roundTrip(bytes), bytes);
+    }
+    assert.strictEqual(roundTrip('héllo ☃'), 'héllo ☃');
+    let buffer = Buffer.from([ 9, 1, 2, 3 ]).subarray(1);
+    assert.deepStrictEqual(roundTrip(buffer), new Uint8Array([ 1, 2, 3 ]));
+    assert.deepStrictEqual(roundTrip(new Uint8Array([ 4, 5 ]).buffer),
+                           new Uint8Array([ 4, 5 ]));
+  });
+
+  it('round-trips arrays and maps', function() {
+    for (let size of [ 0, 15, 16, 65536 ]) {
+      let array = Array.from({length : size}, (_, i) => i);
+      assert.deepStrictEqual(roundTrip(array), array);
+      let map =
+          Object.fromEntries(array.slice(0, 20).map((i) => [ 'k' + i, i ]));
+      assert.deepStrictEqual(roundTrip(map), map);
+    }
+    let nested = {a : [ 1, {b : null, c : 'd'} ], e : {f : [ [] ]}};
+    assert.deepStrictEqual(roundTrip(nested), nested);
+  });
+
+  it('rejects values without a representation', function() {
+    assert.throws(() => roundTrip(() => 1), /MessagePack/);
+    assert.throws(() => roundTrip(Symbol('s')), /MessagePack/);
+    let deep = [];
+    for (let i = 0; i < 300; i++) {
+      deep = [ deep ];
+    }
+    assert.throws(() => roundTrip(deep), /MessagePack/);
+  });
+
+  it('keeps the exception of a throwing getter', function() {
+    let value = {
+      get x() { throw new Error('getter failed'); }
+    };
+    assert.throws(() => roundTrip(value), /getter failed/);
+    assert.equal(vm.RunValue('echo', 1), 1);
+  });
+
+  it('rejects malformed input', function() {
+    let malformed = [
+      [],                                   // nothing
+      [ 0xc0, 0xc0 ],                       // trailing bytes
+      [ 0xc1 ],                             // reserved
+      [ 0xd4, 0x01, 0x00 ],                 // extension type
+      [ 0xa5, 0x61 ],                       // truncated str
+      [ 0xce, 0x00, 0x00 ],                 // truncated uint32
+      [ 0xcb, 0x00 ],                       // truncated float64
+      [ 0xc6, 0xff, 0xff, 0xff, 0xff ],     // oversized bin
+      [ 0xdb, 0xff, 0xff, 0xff, 0xff ],     // oversized str
+      [ 0xdd, 0xff, 0xff, 0xff, 0xff ],     // oversized array
+      [ 0xdf, 0xff, 0xff, 0xff, 0xff ],     // oversized map
+      [ 0x92, 0x01 ],                       // missing element
+      [ 0x81, 0x90, 0xc0 ],                 // array as a key
+    ];
+    for (let bytes of malformed) {
+      assert.throws(() => decode(bytes), /not a valid MessagePack/,
+                    JSON.stringify(bytes));
+    }
+  });
+
+  it('limits the nesting depth', function() {
+    let nested = (depth) => [...new Array(depth).fill(0x91), 0xc0 ];
+    let value = decode(nested(100));
+    for (let i = 0; i < 100; i++) {
+      value = value[0];
+    }
+    assert.strictEqual(value, null);
+    assert.throws(() => decode(nested(300)), /not a valid MessagePack/);
+  });
+
+  it('defines a __proto__ key as an own property', function() {
+    let value =
+        decode([ 0x81, ...str('__proto__'), 0x81, ...str('polluted'), 0x01 ]);
+    assert.strictEqual(Object.getPrototypeOf(value), Object.prototype);
+    assert.deepStrictEqual(Object.keys(value), [ '__proto__' ]);
+    assert.strictEqual(value.polluted, undefined);
+    assert.strictEqual({}.polluted, undefined);
+  });
+
+  it('accepts integer keys and float32', function() {
+    assert.deepStrictEqual(decode([ 0x81, 0x07, 0xc3 ]), {7 : true});
+    assert.strictEqual(decode([ 0xca, 0x3f, 0xc0, 0x00, 0x00 ]), 1.5);
+  });
+});
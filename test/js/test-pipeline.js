@@ -0,0 +1,45 @@
+const assert = require('assert');
+const ssvm = require('../..');
+
+describe('pipeline', function() {
+  let inputName = 'pkg/integers_lib_bg.wasm';
+  // See data/multi_value.wat
+  let multiValueName = 'data/multi_value.wasm';
+
+  function text(bytes) { return Buffer.from(bytes).toString(); }
+
+  it('chains the steps in the wasm memory', function() {
+    let vm = new ssvm.VM(inputName);
+    assert.equal(text(vm.Pipeline([ 'reverse' ], 'abc')), 'cba');
+    assert.equal(text(vm.Pipeline([ 'reverse', 'echo', 'reverse' ], 'abc')),
+                 'abc');
+    let bytes = new Uint8Array([ 1, 2, 3 ]);
+    assert.deepEqual(Array.from(vm.Pipeline([ 'echo', 'reverse' ], bytes)),
+                     [ 3, 2, 1 ]);
+  });
+
+  it('appends the arguments of a step', function() {
+    let vm = new ssvm.VM(inputName);
+    let steps = [ 'reverse', {name : 'append', args : [ 100 ]}, 'reverse' ];
+    assert.equal(text(vm.Pipeline(steps, 'abc')), 'dabc');
+    assert.equal(text(vm.Pipeline([ {name : 'echo'} ], 'abc')), 'abc');
+  });
+
+  it('mixes both return conventions', function() {
+    let vm = new ssvm.VM(multiValueName);
+    assert.equal(text(vm.Pipeline([ 'tail' ], 'abcdef')), 'bcdef');
+    assert.equal(text(vm.Pipeline([ 'tail_ret' ], 'abcdef')), 'bcdef');
+    assert.equal(text(vm.Pipeline([ 'tail', 'tail_ret', 'tail' ], 'abcdef')),
+                 'def');
+  });
+
+  it('rejects invalid steps', function() {
+    let vm = new ssvm.VM(inputName);
+    assert.throws(() => vm.Pipeline([], 'abc'));
+    assert.throws(() => vm.Pipeline('reverse', 'abc'));
+    assert.throws(() => vm.Pipeline([ 'reverse', 42 ], 'abc'));
+    assert.throws(() => vm.Pipeline([ 'reverse', 'missing' ], 'abc'));
+    // The VM is still usable afterwards
+    assert.equal(text(vm.Pipeline([ 'reverse' ], 'abc')), 'cba');
+  });
+});
@@ -0,0 +1,23 @@
+const assert = require('assert');
+const ssvm = require('../..');
+
+describe('prefault', function() {
+  let inputName = 'pkg/integers_lib_bg.wasm';
+
+  it('keeps the results of the linear memory advice', function() {
+    let vm = new ssvm.VM(inputName, {HugePages : true, PrefaultMemory : true});
+    assert.equal(vm.RunInt('lcm_s32', 123, 1011), 41451);
+    vm.StreamBegin();
+    vm.StreamEnd();
+    assert.equal(vm.RunInt('lcm_s32', 123, 1011), 41451);
+  });
+
+  it('runs pinned AOT code', function() {
+    this.timeout(0);
+    let options = {EnableAOT : true, HugePages : true, PrefaultAOT : true};
+    let vm = new ssvm.VM(inputName, options);
+    assert.equal(vm.RunInt('lcm_s32', 123, 1011), 41451);
+    let other = new ssvm.VM(inputName, options);
+    assert.equal(other.RunInt('lcm_s32', 123, 1011), 41451);
+  });
+});
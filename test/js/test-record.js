@@ -0,0 +1,88 @@
+const assert = require('assert');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const ssvm = require('../..');
+const {readLog, replay} = require('../../bin/wasmedge-replay.js');
+
+describe('record', function() {
+  let inputName = 'pkg/integers_lib_bg.wasm';
+  let dir;
+
+  before(function() {
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), 'wasmedge-record-'));
+  });
+
+  // The writer flushes at least every 100 ms
+  let flushed = () => new Promise((resolve) => setTimeout(resolve, 300));
+
+  it('records the calls and replays them', async function() {
+    let log = path.join(dir, 'calls.werc');
+    let vm = new ssvm.VM(inputName, {Record : log});
+    assert.equal(vm.RunInt('lcm_s32', 123, 1011), 41451);
+    vm.RunUint8Array('accumulate', new Uint8Array([ 1, 2, 3 ]));
+    assert.throws(() => vm.RunInt('no_such_function', 1));
+    assert.equal(vm.GetStatistics().Recorded, 3);
+    await flushed();
+
+    let records = readLog(log);
+    assert.equal(records.length, 3);
+    assert.equal(records[0].method, 'RunInt');
+    assert.equal(records[0].name, 'lcm_s32');
+    assert.deepEqual(records[0].args, [ 123, 1011 ]);
+    assert.ok(records[0].ok);
+    assert.deepEqual([...records[1].args[0] ], [ 1, 2, 3 ]);
+    assert.equal(records[2].ok, false);
+
+    let report = replay(records, new ssvm.VM(inputName),
+                        {repeat : 2, warmup : 0});
+    assert.equal(report.lcm_s32.calls, 1);
+    assert.equal(report.lcm_s32.mismatches, 0);
+    assert.equal(report.no_such_function.mismatches, 0);
+  });
+
+  it('samples the calls', async function() {
+    let log = path.join(dir, 'sampled.werc');
+    let vm = new ssvm.VM(inputName, {Record : log, RecordSampleRate : 0});
+    for (let i = 0; i < 10; i++) {
+      vm.RunInt('lcm_s32', 123, 1011);
+    }
+    assert.equal(vm.GetStatistics().Recorded, 0);
+    await flushed();
+    assert.equal(readLog(log).length, 0);
+  });
+
+  it('records only the executed calls', async function() {
+    let log = path.join(dir, 'executed.werc');
+    let vm = new ssvm.VM(inputName, {Record : log, Memoize : [ 'echo' ]});
+    assert.equal(vm.RunString('echo', 'abc'), 'abc');
+    // Returned from the Memoize cache
+    assert.equal(vm.RunString('echo', 'abc'), 'abc');
+    assert.equal(Buffer.from(vm.RunUint8Array('echo', 'abc')).toString(),
+                 'abc');
+    // Rejected while a stream is in progress
+    vm.StreamBegin();
+    assert.throws(() => vm.RunInt('lcm_s32', 123, 1011));
+    vm.StreamEnd();
+    assert.equal(vm.GetStatistics().MemoHits, 2);
+    assert.equal(vm.GetStatistics().Recorded, 1);
+    await flushed();
+    let records = readLog(log);
+    assert.equal(records.length, 1);
+    assert.equal(records[0].method, 'RunString');
+  });
+
+  it('checks its options', function() {
+    assert.throws(() => new ssvm.VM(inputName, {Record : 1}));
+    assert.throws(() => new ssvm.VM(inputName, {RecordSampleRate : 2}));
+    assert.throws(() => new ssvm.VM(
+                      inputName, {Record : path.join(dir, 'no', 'log')}));
+  });
+
+  after(function() {
+    for (let name of fs.readdirSync(dir)) {
+      fs.unlinkSync(path.join(dir, name));
+    }
+    fs.rmdirSync(dir);
+  });
+});
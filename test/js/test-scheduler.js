@@ -0,0 +1,88 @@
+const assert = require('assert');
+const ssvm = require('../..');
+
+describe('scheduler', function() {
+  let inputName = 'pkg/integers_lib_bg.wasm';
+
+  it('runs calls off the JS thread', async function() {
+    let vm = new ssvm.VM(inputName);
+    let out = await vm.RunAsync('accumulate', 'abc', {Tenant : 'a'});
+    assert.ok(out instanceof Uint8Array);
+    assert.equal(out.length, 4);
+
+    let stat = vm.GetSchedulerStatistics();
+    assert.ok(stat.Threads > 0);
+    assert.equal(stat.Tenants.a.Completed, 1);
+    assert.equal(stat.Tenants.a.Queued, 0);
+    assert.ok(stat.Tenants.a.QueueTimeMax >= 0);
+  });
+
+  it('runs higher priorities first', async function() {
+    let vm = new ssvm.VM(inputName, {SchedulerThreads : 1});
+    let order = [];
+    let calls = [];
+    for (let i = 0; i < 20; i++) {
+      let options = {Tenant : 'batch', Priority : 2};
+      calls.push(vm.RunAsync('accumulate', 'x', options)
+                     .then(() => order.push('batch')));
+    }
+    calls.push(vm.RunAsync('accumulate', 'x', {Tenant : 'ui', Priority : 0})
+                   .then(() => order.push('ui')));
+    await Promise.all(calls);
+    // At most the batch call which was already running goes first
+    assert.ok(order.indexOf('ui') <= 1);
+  });
+
+  it('shares the threads by weight', async function() {
+    let vm = new ssvm.VM(inputName, {
+      SchedulerThreads : 1,
+      Tenants : {
+        heavy : {Weight : 1},
+        light : {Weight : 4, MaxConcurrency : 1},
+      },
+    });
+    let calls = [];
+    for (let i = 0; i < 50; i++) {
+      calls.push(vm.RunAsync('accumulate', 'x', {Tenant : 'heavy'}));
+      calls.push(vm.RunAsync('accumulate', 'x', {Tenant : 'light'}));
+    }
+    await Promise.all(calls);
+    let stat = vm.GetSchedulerStatistics();
+    assert.equal(stat.Tenants.heavy.Completed, 50);
+    assert.equal(stat.Tenants.light.Completed, 50);
+    assert.ok(stat.Tenants.light.QueueTimeP50 <=
+              stat.Tenants.heavy.QueueTimeP50);
+  });
+
+  it('scales the threads with the queue', async function() {
+    let vm = new ssvm.VM(inputName, {
+      SchedulerThreads : 2,
+      SchedulerMinThreads : 0,
+      SchedulerTargetQueueTime : 1,
+      SchedulerIdleTimeout : 50,
+    });
+    let calls = [];
+    for (let i = 0; i < 200; i++) {
+      calls.push(vm.RunAsync('accumulate', 'x'));
+    }
+    await Promise.all(calls);
+    let stat = vm.GetSchedulerStatistics();
+    assert.ok(stat.Threads <= 2);
+    assert.ok(stat.ScaleUps >= 1);
+
+    await new Promise((resolve) => setTimeout(resolve, 500));
+    stat = vm.GetSchedulerStatistics();
+    assert.equal(stat.Threads, 0);
+    assert.equal(stat.ScaleDowns, stat.ScaleUps);
+    assert.equal(stat.MemoryBytes, 0);
+  });
+
+  it('checks its arguments', function() {
+    let vm = new ssvm.VM(inputName);
+    assert.throws(() => vm.RunAsync('accumulate', 42));
+    assert.throws(() => vm.RunAsync('accumulate', 'x', {Priority : 3}));
+    assert.throws(() => vm.SetTenant('a', {Weight : 0}));
+    assert.throws(() => new ssvm.VM(inputName, {SchedulerMinThreads : -1}));
+    assert.throws(() => new ssvm.VM(inputName, {SchedulerIdleTimeout : 0}));
+  });
+});
@@ -0,0 +1,60 @@
+const assert = require('assert');
+const ssvm = require('../..');
+
+describe('session', function() {
+  let inputName = 'pkg/integers_lib_bg.wasm';
+
+  function total(bytes) {
+    return Buffer.from(bytes.buffer, bytes.byteOffset, 4).readUInt32LE(0);
+  }
+
+  it('keeps the state of each key', function() {
+    let vm = new ssvm.VM(inputName);
+    let alice = vm.Session('alice');
+    let bob = vm.Session('bob');
+    assert.equal(total(alice.RunUint8Array('accumulate', 'abc')), 3);
+    assert.equal(total(bob.RunUint8Array('accumulate', new Uint8Array(5))), 5);
+    assert.equal(total(alice.RunUint8Array('accumulate', 'de')), 5);
+    assert.equal(total(vm.Session('alice').RunUint8Array('accumulate', 'f')),
+                 6);
+
+    let stat = vm.GetStatistics();
+    assert.equal(stat.Sessions, 2);
+    assert.equal(stat.SessionHits, 2);
+    assert.equal(stat.SessionMisses, 2);
+    assert.ok(stat.SessionMemoryPages > 0);
+
+    assert.ok(alice.End());
+    assert.ok(!alice.End());
+    assert.equal(total(alice.RunUint8Array('accumulate', 'abc')), 3);
+  });
+
+  it('evicts the least recently used session', function() {
+    let vm = new ssvm.VM(inputName, {MaxSessions : 2});
+    vm.Session('a').RunUint8Array('accumulate', 'x');
+    vm.Session('b').RunUint8Array('accumulate', 'x');
+    vm.Session('a').RunUint8Array('accumulate', 'x');
+    vm.Session('c').RunUint8Array('accumulate', 'x');
+    let stat = vm.GetStatistics();
+    assert.equal(stat.Sessions, 2);
+    assert.equal(stat.SessionEvictions, 1);
+    assert.equal(total(vm.Session('a').RunUint8Array('accumulate', 'x')), 3);
+    assert.equal(total(vm.Session('b').RunUint8Array('accumulate', 'x')), 1);
+  });
+
+  it('expires idle sessions', async function() {
+    let vm = new ssvm.VM(inputName, {SessionIdleTimeout : 50});
+    vm.Session('a').RunUint8Array('accumulate', 'x');
+    await new Promise((resolve) => setTimeout(resolve, 100));
+    let stat = vm.GetStatistics();
+    assert.equal(stat.Sessions, 0);
+    assert.equal(stat.SessionExpirations, 1);
+  });
+
+  it('does not touch the other calls', function() {
+    let vm = new ssvm.VM(inputName);
+    vm.Session('a').RunUint8Array('accumulate', 'x');
+    assert.equal(vm.RunInt('lcm_s32', 123, 1011), 41451);
+    assert.throws(() => vm.SessionRun('a', 'accumulate', 42));
+  });
+});
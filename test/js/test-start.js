@@ -0,0 +1,38 @@
+const assert = require('assert');
+const path = require('path');
+const ssvm = require('../..');
+
+describe('start', function() {
+  let commandName = path.join('target', 'wasm32-wasi', 'release',
+                              'print_args.wasm');
+
+  function stdout(result) { return Buffer.from(result.Stdout).toString(); }
+
+  it('keeps the args option between runs', function() {
+    let vm = new ssvm.VM(commandName, {
+      EnableWasiStartFunction : true,
+      // Like process.argv, the first two entries are dropped
+      args : [ 'node', 'script.js', 'first', 'second' ],
+      CaptureOutput : true,
+    });
+    assert.equal(stdout(vm.Start()), 'first\nsecond\n');
+    assert.equal(stdout(vm.StartWith({args : [ 'tool', 'a' ]})), 'tool\na\n');
+    assert.equal(stdout(vm.StartWith(
+                     {args : [ 'tool', 'b', 'c' ], env : {GREETING : 'hi'}})),
+                 'tool\nb\nc\nGREETING=hi\n');
+    // Neither the previous runs nor StartWith() changed the options
+    assert.equal(stdout(vm.Start()), 'first\nsecond\n');
+    assert.equal(stdout(vm.Start()), 'first\nsecond\n');
+  });
+
+  it('takes the env option by default', function() {
+    let vm = new ssvm.VM(commandName, {
+      EnableWasiStartFunction : true,
+      env : {GREETING : 'hello'},
+      CaptureOutput : true,
+    });
+    assert.equal(stdout(vm.StartWith({args : [ 'tool' ]})),
+                 'tool\nGREETING=hello\n');
+    assert.equal(stdout(vm.StartWith()), 'GREETING=hello\n');
+  });
+});
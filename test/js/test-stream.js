@@ -0,0 +1,78 @@
+const assert = require('assert');
+const {once} = require('events');
+const {Readable} = require('stream');
+const ssvm = require('../..');
+
+describe('stream', function() {
+  let inputName = 'pkg/integers_lib_bg.wasm';
+
+  async function collect(stream) {
+    let chunks = [];
+    for await (const chunk of stream) {
+      chunks.push(chunk);
+    }
+    return Buffer.concat(chunks);
+  }
+
+  function stats(bytes) {
+    return [ bytes.readUInt32LE(0), bytes.readUInt32LE(4) ];
+  }
+
+  it('splits the input into chunks of one instance', async function() {
+    let vm = new ssvm.VM(inputName);
+    let input = [ Buffer.from('abcdefghij'), Buffer.from('kl') ];
+    let out = await collect(Readable.from(input).pipe(
+        vm.Stream('stream_chunk', 'stream_stats', {maxChunkSize : 4})));
+    assert.equal(out.subarray(0, 12).toString(), 'abcdefghijkl');
+    // 4 + 4 + 2 bytes, then 2 bytes, all seen by the same instance
+    assert.deepEqual(stats(out.subarray(12)), [ 4, 12 ]);
+  });
+
+  it('applies backpressure', async function() {
+    let vm = new ssvm.VM(inputName);
+    let stream = vm.Stream('stream_chunk', 'stream_stats',
+                           {highWaterMark : 16});
+    let written = 0;
+    while (stream.write(Buffer.alloc(16, 1))) {
+      written += 16;
+      assert.ok(written < 1024);
+    }
+    // The output is not read, so the writer has to wait
+    written += 16;
+    let output = collect(stream);
+    await once(stream, 'drain');
+    stream.end();
+    let out = await output;
+    assert.equal(out.length, written + 8);
+    assert.equal(stats(out.subarray(written))[1], written);
+  });
+
+  it('ends the instance when destroyed', async function() {
+    let vm = new ssvm.VM(inputName);
+    let stream = vm.Stream('stream_chunk', 'stream_stats');
+    stream.write(Buffer.from('abc'));
+    stream.destroy();
+    await once(stream, 'close');
+    assert.equal(vm.RunInt('lcm_s32', 123, 1011), 41451);
+    // A new stream starts from a new instance
+    stream = vm.Stream('stream_chunk', 'stream_stats');
+    let out = await collect(Readable.from([ Buffer.from('de') ]).pipe(stream));
+    assert.deepEqual(stats(out.subarray(2)), [ 1, 2 ]);
+  });
+
+  it('rejects other calls while in progress', async function() {
+    let vm = new ssvm.VM(inputName);
+    let stream = vm.Stream('stream_chunk');
+    stream.write(Buffer.from('abc'));
+    assert.throws(() => vm.RunInt('lcm_s32', 123, 1011),
+                  /stream is in progress/);
+    assert.throws(() => vm.RunString('echo', 'abc'), /stream is in progress/);
+    assert.throws(() => vm.Pipeline([ 'echo' ], 'abc'),
+                  /stream is in progress/);
+    assert.throws(() => vm.StreamBegin(), /stream is in progress/);
+    let output = collect(stream);
+    stream.end();
+    assert.equal((await output).toString(), 'abc');
+    assert.equal(vm.RunInt('lcm_s32', 123, 1011), 41451);
+  });
+});
@@ -0,0 +1,59 @@
+const assert = require('assert');
+const fs = require('fs');
+const ssvm = require('../..');
+
+describe('swap module', function() {
+  let inputName = 'pkg/integers_lib_bg.wasm';
+
+  let cases = new Map([
+    [ 'interpreter', false ],
+    [ 'aot', true ],
+  ]);
+
+  cases.forEach(function(aot, caseName) {
+    it('swaps between calls (' + caseName + ')', async function() {
+      this.timeout(0);
+      let vm = new ssvm.VM(inputName, {EnableAOT : aot});
+      assert.equal(vm.RunInt('lcm_s32', 123, 1011), 41451);
+
+      let swap = vm.SwapModule(fs.readFileSync(inputName));
+      // The current module keeps serving while the new one is prepared
+      assert.equal(vm.RunInt('lcm_s32', 123, 1011), 41451);
+      let res = await swap;
+      assert.ok(res.Applied);
+      assert.equal(res.Compiled, aot);
+      assert.equal(vm.RunInt('lcm_s32', 123, 1011), 41451);
+      assert.equal(vm.GetStatistics().ModuleSwaps, 1);
+    });
+  });
+
+  it('moves existing sessions to the new module', async function() {
+    let vm = new ssvm.VM(inputName);
+    let total = (bytes) =>
+        Buffer.from(bytes.buffer, bytes.byteOffset, 4).readUInt32LE(0);
+    let session = vm.Session('alice');
+    assert.equal(total(session.RunUint8Array('accumulate', 'abc')), 3);
+    assert.ok((await vm.SwapModule(fs.readFileSync(inputName))).Applied);
+    // A new instance of the new module, without the state of the old one
+    assert.equal(total(session.RunUint8Array('accumulate', 'de')), 2);
+    assert.equal(total(session.RunUint8Array('accumulate', 'f')), 3);
+    assert.equal(vm.GetStatistics().Sessions, 1);
+  });
+
+  it('keeps only the most recent swap', async function() {
+    let vm = new ssvm.VM(inputName);
+    let first = vm.SwapModule(inputName);
+    let second = vm.SwapModule(fs.readFileSync(inputName));
+    let results = await Promise.all([ first, second ]);
+    assert.ok(results[1].Applied);
+    assert.equal(vm.GetStatistics().ModuleSwaps,
+                 results.filter((r) => r.Applied).length);
+  });
+
+  it('rejects invalid modules', async function() {
+    let vm = new ssvm.VM(inputName);
+    assert.throws(() => vm.SwapModule(new Uint8Array([ 1, 2, 3 ])));
+    await assert.rejects(vm.SwapModule('does/not/exist.wasm'));
+    assert.equal(vm.RunInt('lcm_s32', 123, 1011), 41451);
+  });
+});
@@ -0,0 +1,86 @@
+const assert = require('assert');
+const {Worker} = require('worker_threads');
+const ssvm = require('../..');
+
+describe('worker_threads', function() {
+  let inputName = 'pkg/integers_lib_bg.wasm';
+
+  function runInWorker(handle) {
+    return new Promise((resolve, reject) => {
+      let worker = new Worker(`
+        const {parentPort, workerData} = require('worker_threads');
+        const ssvm = require(workerData.addon);
+        let vm = new ssvm.VM(workerData.handle, {
+          EnableAOT : workerData.aot,
+        });
+        parentPort.postMessage(vm.RunInt('lcm_s32', 123, 1011));
+      `,
+                              {
+                                eval : true,
+                                workerData : {
+                                  addon : require.resolve('../..'),
+                                  handle : handle,
+                                  aot : handle.aot,
+                                },
+                              });
+      worker.once('message', resolve);
+      worker.once('error', reject);
+    });
+  }
+
+  let cases = new Map([
+    [ 'interpreter', false ],
+    [ 'aot', true ],
+  ]);
+
+  cases.forEach(function(aot, caseName) {
+    it('share module with workers (' + caseName + ')', async function() {
+      this.timeout(0);
+
+      let vm = new ssvm.VM(inputName, {EnableAOT : aot});
+      let handle = vm.Share();
+      handle.aot = aot;
+
+      let results =
+          await Promise.all([ runInWorker(handle), runInWorker(handle) ]);
+      results.forEach((r) => assert.equal(r, 41451));
+      assert.equal(vm.RunInt('lcm_s32', 123, 1011), 41451);
+      assert.ok(ssvm.VM.ReleaseSharedModule(handle));
+    });
+  });
+
+  it('rejects released handles', function() {
+    let vm = new ssvm.VM(inputName);
+    let handle = vm.Share();
+    assert.ok(ssvm.VM.ReleaseSharedModule(handle));
+    assert.throws(() => new ssvm.VM(handle));
+  });
+
+  it('RunParallel returns the results in order', async function() {
+    let vm = new ssvm.VM(inputName);
+    let inputs = [];
+    for (let i = 1; i <= 100; i++) {
+      inputs.push(`${i},${i + 1}`);
+    }
+    let results = await vm.RunParallel('lcm_str', inputs, 4);
+    assert.equal(results.length, 100);
+    results.forEach((bytes, i) => {
+      assert.ok(bytes instanceof Uint8Array);
+      assert.equal(Buffer.from(bytes).toString(), String((i + 1) * (i + 2)));
+    });
+    // Strings and bytes can be mixed, fewer inputs than threads
+    let mixed = await vm.RunParallel(
+        'lcm_str', [ '4,6', Buffer.from('10,15'), new Uint8Array() ], 8);
+    assert.deepEqual(mixed.map((bytes) => Buffer.from(bytes).toString()),
+                     [ '12', '30', '0' ]);
+  });
+
+  it('RunParallel checks its inputs', async function() {
+    let vm = new ssvm.VM(inputName);
+    assert.throws(() => vm.RunParallel('lcm_s32', [ 1, 2 ]));
+    assert.throws(() => vm.RunParallel('lcm_s32'));
+    // lcm_s32 does not take a byte buffer, every thread fails
+    await assert.rejects(vm.RunParallel('lcm_s32', [ 'a', 'b', 'c' ], 2));
+    assert.deepEqual(await vm.RunParallel('lcm_s32', []), []);
+  });
+});
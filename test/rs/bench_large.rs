@@ -0,0 +1,98 @@
+use wasm_bindgen::prelude::*;
+
+// Large module of bench/prefault.js. The zeroed table only grows the initial
+// linear memory, whose pages are faulted in by the first writes. The unrolled
+// rounds grow the code, so that the AOT module spans many pages as well.
+
+const TABLE_SIZE: usize = 32 * 1024 * 1024;
+static mut TABLE: [u8; TABLE_SIZE] = [0; TABLE_SIZE];
+
+macro_rules! round {
+  ($x:ident, $k:expr) => {
+    $x = ($x ^ (($k as u64) << 17 | $k as u64))
+      .wrapping_mul(0x9e3779b97f4a7c15)
+      .rotate_left(($k % 61 + 1) as u32);
+  };
+}
+macro_rules! rounds4 {
+  ($x:ident, $k:expr) => {
+    round!($x, $k * 4);
+    round!($x, $k * 4 + 1);
+    round!($x, $k * 4 + 2);
+    round!($x, $k * 4 + 3);
+  };
+}
+macro_rules! rounds16 {
+  ($x:ident, $k:expr) => {
+    rounds4!($x, $k * 4);
+    rounds4!($x, $k * 4 + 1);
+    rounds4!($x, $k * 4 + 2);
+    rounds4!($x, $k * 4 + 3);
+  };
+}
+macro_rules! rounds256 {
+  ($x:ident, $k:expr) => {
+    rounds16!($x, $k * 16);
+    rounds16!($x, $k * 16 + 1);
+    rounds16!($x, $k * 16 + 2);
+    rounds16!($x, $k * 16 + 3);
+    rounds16!($x, $k * 16 + 4);
+    rounds16!($x, $k * 16 + 5);
+    rounds16!($x, $k * 16 + 6);
+    rounds16!($x, $k * 16 + 7);
+    rounds16!($x, $k * 16 + 8);
+    rounds16!($x, $k * 16 + 9);
+    rounds16!($x, $k * 16 + 10);
+    rounds16!($x, $k * 16 + 11);
+    rounds16!($x, $k * 16 + 12);
+    rounds16!($x, $k * 16 + 13);
+    rounds16!($x, $k * 16 + 14);
+    rounds16!($x, $k * 16 + 15);
+  };
+}
+
+#[inline(never)]
+fn mix0(mut x: u64) -> u64 {
+  rounds256!(x, 0);
+  return x;
+}
+
+#[inline(never)]
+fn mix1(mut x: u64) -> u64 {
+  rounds256!(x, 1);
+  return x;
+}
+
+#[inline(never)]
+fn mix2(mut x: u64) -> u64 {
+  rounds256!(x, 2);
+  return x;
+}
+
+#[inline(never)]
+fn mix3(mut x: u64) -> u64 {
+  rounds256!(x, 3);
+  return x;
+}
+
+// One random write into the table per input byte, through code spread over
+// the whole module. Returns 4 bytes, so that the result costs nothing.
+#[wasm_bindgen]
+pub fn walk(b: &[u8]) -> Vec<u8> {
+  let mut h: u64 = 0xcbf29ce484222325;
+  let mut sum: u32 = 0;
+  for x in b {
+    h = match *x & 3 {
+      0 => mix0(h ^ *x as u64),
+      1 => mix1(h ^ *x as u64),
+      2 => mix2(h ^ *x as u64),
+      _ => mix3(h ^ *x as u64),
+    };
+    let i = (h % TABLE_SIZE as u64) as usize;
+    unsafe {
+      TABLE[i] = TABLE[i].wrapping_add(1);
+      sum = sum.wrapping_add(TABLE[i] as u32);
+    }
+  }
+  return sum.to_le_bytes().to_vec();
+}
@@ -0,0 +1,39 @@
+use wasm_bindgen::prelude::*;
+
+// Workloads of bench/run-paths.js, one per Run* path. They do as little as
+// possible, so that the measurements show the cost of the calls themselves.
+
+#[wasm_bindgen]
+pub fn noop() {}
+
+#[wasm_bindgen]
+pub fn add_i32(a: i32, b: i32) -> i32 {
+  return a.wrapping_add(b);
+}
+
+#[wasm_bindgen]
+pub fn add_i64(a: i64, b: i64) -> i64 {
+  return a.wrapping_add(b);
+}
+
+#[wasm_bindgen]
+pub fn echo_string(s: &str) -> String {
+  return s.to_string();
+}
+
+#[wasm_bindgen]
+pub fn echo_bytes(b: &[u8]) -> Vec<u8> {
+  return b.to_vec();
+}
+
+// Reads the whole input but returns 8 bytes, to separate the cost of passing
+// the arguments from the cost of returning the result.
+#[wasm_bindgen]
+pub fn fnv1a(b: &[u8]) -> Vec<u8> {
+  let mut h: u64 = 0xcbf29ce484222325;
+  for x in b {
+    h ^= *x as u64;
+    h = h.wrapping_mul(0x100000001b3);
+  }
+  return h.to_le_bytes().to_vec();
+}
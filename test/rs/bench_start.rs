@@ -0,0 +1,15 @@
+// Command for the Start() path of bench/run-paths.js. The optional argument
+// is a number of loop iterations, the default measures the startup only.
+fn main() {
+  let n: u64 = std::env::args()
+    .nth(1)
+    .and_then(|s| s.parse().ok())
+    .unwrap_or(0);
+  let mut x: u64 = 0;
+  for i in 0..n {
+    x = x.wrapping_mul(31).wrapping_add(i);
+  }
+  if x == 1 {
+    println!("{}", x);
+  }
+}
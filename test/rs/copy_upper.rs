@@ -0,0 +1,16 @@
+// Command for the memfs tests. Prints the file named by the first argument,
+// writes it in upper case to the file named by the second one when given,
+// then reports on stderr what it did.
+use std::fs;
+
+fn main() {
+  let args: Vec<String> = std::env::args().collect();
+  let text = fs::read_to_string(&args[0]).expect("cannot read input");
+  print!("{}", text);
+  if args.len() > 1 {
+    fs::write(&args[1], text.to_uppercase()).expect("cannot write output");
+    eprintln!("copied {} to {}", args[0], args[1]);
+  } else {
+    eprintln!("read {}", args[0]);
+  }
+}
@@ -24,3 +24,97 @@ pub fn lcm_u64(a: u64, b: u64) -> u64 {
   let r = lcm(a, b);
   return r;
 }
+
+// lcm of "a,b" as a string, for the tests of the calls taking a buffer
+#[wasm_bindgen]
+pub fn lcm_str(s: &str) -> String {
+  let mut it = s.split(',').map(|x| x.trim().parse::<i64>().unwrap_or(0));
+  let a = it.next().unwrap_or(0);
+  let b = it.next().unwrap_or(0);
+  return lcm(a, b).to_string();
+}
+
+// Take and return i64 values in registers, unlike the wasm-bindgen exports
+// above, for the calling convention tests
+#[no_mangle]
+pub extern "C" fn lcm_s64_native(a: i64, b: i64) -> i64 {
+  return lcm(a, b);
+}
+
+#[no_mangle]
+pub extern "C" fn lcm_u64_native(a: u64, b: u64) -> u64 {
+  return lcm(a, b);
+}
+
+static mut TOTAL: u32 = 0;
+
+// Keeps a running total in the linear memory, for the session tests
+#[wasm_bindgen]
+pub fn accumulate(b: &[u8]) -> Vec<u8> {
+  unsafe {
+    TOTAL = TOTAL.wrapping_add(b.len() as u32);
+    return TOTAL.to_le_bytes().to_vec();
+  }
+}
+
+// Returns its input, for the marshalling tests
+#[wasm_bindgen]
+pub fn echo(b: &[u8]) -> Vec<u8> {
+  return b.to_vec();
+}
+
+// Reverses its input, for the pipeline tests
+#[wasm_bindgen]
+pub fn reverse(b: &[u8]) -> Vec<u8> {
+  return b.iter().rev().cloned().collect();
+}
+
+// Appends one byte to its input, for the pipeline steps with arguments
+#[wasm_bindgen]
+pub fn append(b: &[u8], x: u8) -> Vec<u8> {
+  let mut v = b.to_vec();
+  v.push(x);
+  return v;
+}
+
+static mut STREAM_CHUNKS: u32 = 0;
+static mut STREAM_BYTES: u32 = 0;
+
+// Returns its input and counts the chunks, for the stream tests
+#[wasm_bindgen]
+pub fn stream_chunk(b: &[u8]) -> Vec<u8> {
+  unsafe {
+    STREAM_CHUNKS += 1;
+    STREAM_BYTES += b.len() as u32;
+  }
+  return b.to_vec();
+}
+
+// Number of chunks and bytes seen by stream_chunk, as two u32 LE
+#[wasm_bindgen]
+pub fn stream_stats() -> Vec<u8> {
+  unsafe {
+    let mut v = STREAM_CHUNKS.to_le_bytes().to_vec();
+    v.extend_from_slice(&STREAM_BYTES.to_le_bytes());
+    return v;
+  }
+}
+
+// Returns the payload of a MessagePack bin, so that the tests can hand any
+// bytes to the decoder
+#[wasm_bindgen]
+pub fn unwrap_bin(b: &[u8]) -> Vec<u8> {
+  let header = match b.first() {
+    Some(&0xc4) => 2,
+    Some(&0xc5) => 3,
+    Some(&0xc6) => 5,
+    _ => 0,
+  };
+  return b[header.min(b.len())..].to_vec();
+}
+
+// A string of n 'a', for the memoization tests with number arguments
+#[wasm_bindgen]
+pub fn repeat_a(n: i32) -> String {
+  return "a".repeat(n.max(0) as usize);
+}
@@ -0,0 +1,10 @@
+// Command for the Start() and StartWith() tests. Prints every argument on
+// its own line, then GREETING from the environment when it is set.
+fn main() {
+  for arg in std::env::args() {
+    println!("{}", arg);
+  }
+  if let Ok(greeting) = std::env::var("GREETING") {
+    println!("GREETING={}", greeting);
+  }
+}
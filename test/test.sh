@@ -1,6 +1,8 @@
 #!/usr/bin/env bash
 set -xe
 rustwasmc build
+cargo build --release --target wasm32-wasi --bin print_args
+cargo build --release --target wasm32-wasi --bin copy_upper
 cd pkg
 npm install ../..
 sed -i "s/require('ssvm')/require('wasmedge-core')/" integers_lib.js